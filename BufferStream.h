@@ -0,0 +1,234 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_BUFFER_STREAM_HEADER_FILE
+#define MZ_BUFFER_STREAM_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "globals.h"
+#include "zstream.h"
+#include "Vector.h"
+#include "Span.h"
+
+/**
+ * @file BufferStream.h
+ * @brief In-memory mz::Stream over one contiguous, growable mz::Vector<char>.
+ *
+ * This header defines:
+ *   - mz::BufferStream: drop-in replacement for StringStream without std::stringstream's
+ *     locale/sentry overhead, with zero-copy access to the bytes.
+ *
+ * Writes append at the end of the buffer (growing geometrically); reads consume from a
+ * separate cursor, as with StringStream. reset() and rewind() keep the allocation, so one
+ * BufferStream can serve many round trips, and adopt()/release() move whole buffers in and
+ * out without copying.
+ *
+ * Usage example:
+ *   mz::BufferStream bs;
+ *   bs.reserve(1 << 20);
+ *   request.save(bs);
+ *   send(bs.view());                   // Span<const char> over the written bytes
+ *   bs.reset();                        // ready for the next message, capacity kept
+ *
+ *   mz::BufferStream in(std::move(received));   // adopt a Vector<char> for reading
+ *   reply.load(in);
+ */
+
+namespace mz {
+
+    /**
+     * @brief Stream over a contiguous byte buffer with independent read cursor.
+     *
+     * Reading past the written bytes yields zeros and sets failed().
+     */
+    class BufferStream final : public Stream {
+        Vector<char> buffer_;                    // written bytes are [0, buffer_.size())
+        size_type read_pos_ = 0;
+        bool failed_ = false;
+        mutable MemoryStreamBuffer streambuf_;
+
+        void write_bytes(const char* ptr, arg_type size) noexcept override final {
+            size_type const used = buffer_.size();
+            if (size > buffer_.capacity() - used) {
+                long long const needed = static_cast<long long>(used) + size;
+                long long const doubled = 2ll * buffer_.capacity();
+                buffer_.reserve(std::min<long long>(std::max(needed, doubled), INT_MAX), true);
+                if (needed > buffer_.capacity()) { failed_ = true; return; }
+            }
+            buffer_.resize(used + size, true);
+            memcpy(buffer_.data() + used, ptr, static_cast<size_t>(size));
+        }
+
+        void read_bytes(char* ptr, arg_type size) noexcept override final {
+            size_type const n = std::min(size, buffer_.size() - read_pos_);
+            memcpy(ptr, buffer_.data() + read_pos_, static_cast<size_t>(n));
+            read_pos_ += n;
+            if (n < size) {
+                memset(ptr + n, 0, static_cast<size_t>(size - n));
+                failed_ = true;
+            }
+        }
+
+        void append(std::streambuf* buffer) noexcept {
+            if (!buffer) return;
+            char block[1 << 14];
+            for (std::streamsize n; (n = buffer->sgetn(block, sizeof(block))) > 0; ) write_bytes(block, static_cast<arg_type>(n));
+        }
+
+    public:
+        BufferStream() = default;
+
+        /**
+         * @brief Starts with room for capacity bytes.
+         */
+        explicit BufferStream(size_type capacity) noexcept { reserve(capacity); }
+
+        /**
+         * @brief Adopts bytes for reading without copying.
+         */
+        explicit BufferStream(Vector<char>&& bytes) noexcept : buffer_(std::move(bytes)) {}
+
+        BufferStream(const BufferStream&) = delete;
+        BufferStream& operator=(const BufferStream& rhs) noexcept {
+            if (this != &rhs) {
+                reset();
+                write_bytes(rhs.buffer_.data(), rhs.buffer_.size());
+            }
+            return *this;
+        }
+        ~BufferStream() = default;
+
+        // --- Buffer access ---
+
+        /**
+         * @brief All written bytes (valid until the next write, reserve or adopt).
+         */
+        Span<const char> view() const noexcept { return Span<const char>(buffer_.data(), buffer_.size()); }
+
+        /**
+         * @brief Bytes not yet consumed by reads.
+         */
+        Span<const char> unread() const noexcept { return Span<const char>(buffer_.data() + read_pos_, buffer_.size() - read_pos_); }
+
+        size_type size() const noexcept { return buffer_.size(); }
+        size_type capacity() const noexcept { return buffer_.capacity(); }
+        size_type position() const noexcept { return read_pos_; }
+
+        /**
+         * @brief Ensures room for capacity bytes in total, keeping the content.
+         */
+        void reserve(size_type capacity) noexcept { buffer_.reserve(capacity, true); }
+
+        /**
+         * @brief Drops the content but keeps the allocation.
+         */
+        void reset() noexcept {
+            buffer_.clear();
+            read_pos_ = 0;
+            failed_ = false;
+        }
+
+        /**
+         * @brief Moves the read cursor back to the first byte.
+         */
+        void rewind() noexcept {
+            read_pos_ = 0;
+            failed_ = false;
+        }
+
+        /**
+         * @brief Replaces the content with bytes (moved in) and rewinds.
+         */
+        void adopt(Vector<char>&& bytes) noexcept {
+            buffer_ = std::move(bytes);
+            rewind();
+        }
+
+        /**
+         * @brief Moves the buffer out, leaving the stream empty.
+         */
+        Vector<char> release() noexcept {
+            Vector<char> bytes(std::move(buffer_));
+            reset();
+            return bytes;
+        }
+
+        bool failed() const noexcept override final { return failed_; }
+
+        // --- Stream interface ---
+
+        BufferStream& clear() noexcept override final { reset(); return *this; }
+        BufferStream& operator=(const Stream& rhs) noexcept override final { return clear() << rhs; }
+        BufferStream& operator<<(const Stream& rhs) noexcept override final { append(rhs.rdbuf()); return *this; }
+        std::streambuf* rdbuf() const noexcept override final {
+            char* first = const_cast<char*>(buffer_.data());
+            streambuf_.assign(first, first + read_pos_, first + buffer_.size());
+            return &streambuf_;
+        }
+        bool empty() noexcept override final { return read_pos_ == buffer_.size(); }
+        void end() override final { read_pos_ = buffer_.size(); }
+        void close() override final {}
+        void begin() override final { rewind(); }
+        bool is_open() const noexcept override final { return true; }
+        bool is_file() const noexcept override final { return false; }
+        void flush() noexcept override final {}
+        int64_t tell() noexcept override final { return read_pos_; }
+        int64_t write_position() noexcept override final { return buffer_.size(); }
+        bool overwrite(int64_t offset, const char* ptr, arg_type size) noexcept override final {
+            if (offset < 0 || size < 0 || offset + size > buffer_.size()) return false;
+            memcpy(buffer_.data() + offset, ptr, static_cast<size_t>(size));
+            return true;
+        }
+        bool seek(int64_t offset) noexcept override final {
+            if (offset < 0 || offset > buffer_.size()) return false;
+            read_pos_ = static_cast<size_type>(offset);
+            return true;
+        }
+
+        /**
+         * @brief Appends the content of a file.
+         * @param fname File name to load.
+         */
+        void load(const char* fname) override final {
+            std::fstream f(fname, std::ios::in | std::ios::binary);
+            DOMAIN_ERROR_IF(!f.is_open(), "Error cannot load {}", fname);
+            append(f.rdbuf());
+        }
+
+        /**
+         * @brief Writes all written bytes to a file.
+         * @param fname File name to save.
+         */
+        void save(const char* fname) override final {
+            std::fstream f(fname, std::ios::out | std::ios::binary);
+            DOMAIN_ERROR_IF(!f.is_open(), "Error cannot save {}", fname);
+            f.write(buffer_.data(), buffer_.size());
+        }
+    };
+
+} // namespace mz
+
+#endif // MZ_BUFFER_STREAM_HEADER_FILE
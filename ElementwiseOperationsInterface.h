@@ -274,7 +274,7 @@ namespace mz {
         template <Sequence Seq>
             requires requires(value_type x, typename Seq::value_type y) { x &= y; }
         DerivedT& operator&=(Seq seq) {
-            DOMAIN_ERROR_IF(size() != seq.size(), "elementwise AND size mismatch: {} != {}\n", size(), seq.size());
+            CHECK_DOMAIN_ERROR_IF(size() != seq.size(), "elementwise AND size mismatch: {} != {}\n", size(), seq.size());
             for (size_type i = 0; i < size(); ++i) at(i) &= seq[i];
             return ref();
         }
@@ -286,7 +286,7 @@ namespace mz {
         template <Sequence Seq>
             requires requires(value_type x, typename Seq::value_type y) { x |= y; }
         DerivedT& operator|=(Seq seq) {
-            DOMAIN_ERROR_IF(size() != seq.size(), "elementwise OR size mismatch: {} != {}\n", size(), seq.size());
+            CHECK_DOMAIN_ERROR_IF(size() != seq.size(), "elementwise OR size mismatch: {} != {}\n", size(), seq.size());
             for (size_type i = 0; i < size(); ++i) at(i) |= seq[i];
             return ref();
         }
@@ -298,7 +298,7 @@ namespace mz {
         template <Sequence Seq>
             requires requires(value_type x, typename Seq::value_type y) { x ^= y; }
         DerivedT& operator^=(Seq seq) {
-            DOMAIN_ERROR_IF(size() != seq.size(), "elementwise XOR size mismatch: {} != {}\n", size(), seq.size());
+            CHECK_DOMAIN_ERROR_IF(size() != seq.size(), "elementwise XOR size mismatch: {} != {}\n", size(), seq.size());
             for (size_type i = 0; i < size(); ++i) at(i) ^= seq[i];
             return ref();
         }
@@ -310,7 +310,7 @@ namespace mz {
         template <Sequence Seq>
             requires requires(value_type x, typename Seq::value_type y) { x += y; }
         DerivedT& operator+=(Seq seq) {
-            DOMAIN_ERROR_IF(size() != seq.size(), "elementwise addition size mismatch: {} != {}\n", size(), seq.size());
+            CHECK_DOMAIN_ERROR_IF(size() != seq.size(), "elementwise addition size mismatch: {} != {}\n", size(), seq.size());
             for (size_type i = 0; i < size(); ++i) at(i) += seq[i];
             return ref();
         }
@@ -322,7 +322,7 @@ namespace mz {
         template <Sequence Seq>
             requires requires(value_type x, typename Seq::value_type y) { x -= y; }
         DerivedT& operator-=(Seq seq) {
-            DOMAIN_ERROR_IF(size() != seq.size(), "elementwise subtraction size mismatch: {} != {}\n", size(), seq.size());
+            CHECK_DOMAIN_ERROR_IF(size() != seq.size(), "elementwise subtraction size mismatch: {} != {}\n", size(), seq.size());
             for (size_type i = 0; i < size(); ++i) at(i) -= seq[i];
             return ref();
         }
@@ -334,7 +334,7 @@ namespace mz {
         template <Sequence Seq>
             requires requires(value_type x, typename Seq::value_type y) { x *= y; }
         DerivedT& operator*=(Seq seq) {
-            DOMAIN_ERROR_IF(size() != seq.size(), "elementwise multiplication size mismatch: {} != {}\n", size(), seq.size());
+            CHECK_DOMAIN_ERROR_IF(size() != seq.size(), "elementwise multiplication size mismatch: {} != {}\n", size(), seq.size());
             for (size_type i = 0; i < size(); ++i) at(i) *= seq[i];
             return ref();
         }
@@ -346,7 +346,7 @@ namespace mz {
         template <Sequence Seq>
             requires requires(value_type x, typename Seq::value_type y) { x /= y; }
         DerivedT& operator/=(Seq seq) {
-            DOMAIN_ERROR_IF(size() != seq.size(), "elementwise division size mismatch: {} != {}\n", size(), seq.size());
+            CHECK_DOMAIN_ERROR_IF(size() != seq.size(), "elementwise division size mismatch: {} != {}\n", size(), seq.size());
             for (size_type i = 0; i < size(); ++i) at(i) /= seq[i];
             return ref();
         }
@@ -445,7 +445,7 @@ namespace mz {
          */
         template <typename U, typename Func>
         void apply(std::initializer_list<U> const& values, Func&& func) {
-            DOMAIN_ERROR_IF(size() != values.size(), "ElementwiseMutableOperationsInterface::apply size mismatch");
+            CHECK_DOMAIN_ERROR_IF(size() != values.size(), "ElementwiseMutableOperationsInterface::apply size mismatch");
             U const* src = values.begin();
             for (size_type i = 0; i < size(); ++i) func(at(i), src[i]);
         }
@@ -456,7 +456,7 @@ namespace mz {
         template <typename U>
             requires requires(value_type x, U y) { x &= y; }
         DerivedT& operator&=(std::initializer_list<U> const& values) {
-            DOMAIN_ERROR_IF(size() != values.size(), "elementwise AND size mismatch: {} != {}\n", size(), values.size());
+            CHECK_DOMAIN_ERROR_IF(size() != values.size(), "elementwise AND size mismatch: {} != {}\n", size(), values.size());
             U const* src = values.begin();
             for (size_type i = 0; i < size(); ++i) at(i) &= src[i];
             return ref();
@@ -468,7 +468,7 @@ namespace mz {
         template <typename U>
             requires requires(value_type x, U y) { x |= y; }
         DerivedT& operator|=(std::initializer_list<U> const& values) {
-            DOMAIN_ERROR_IF(size() != values.size(), "elementwise OR size mismatch: {} != {}\n", size(), values.size());
+            CHECK_DOMAIN_ERROR_IF(size() != values.size(), "elementwise OR size mismatch: {} != {}\n", size(), values.size());
             U const* src = values.begin();
             for (size_type i = 0; i < size(); ++i) at(i) |= src[i];
             return ref();
@@ -480,7 +480,7 @@ namespace mz {
         template <typename U>
             requires requires(value_type x, U y) { x ^= y; }
         DerivedT& operator^=(std::initializer_list<U> const& values) {
-            DOMAIN_ERROR_IF(size() != values.size(), "elementwise XOR size mismatch: {} != {}\n", size(), values.size());
+            CHECK_DOMAIN_ERROR_IF(size() != values.size(), "elementwise XOR size mismatch: {} != {}\n", size(), values.size());
             U const* src = values.begin();
             for (size_type i = 0; i < size(); ++i) at(i) ^= src[i];
             return ref();
@@ -492,7 +492,7 @@ namespace mz {
         template <typename U>
             requires requires(value_type x, U y) { x += y; }
         DerivedT& operator+=(std::initializer_list<U> const& values) {
-            DOMAIN_ERROR_IF(size() != values.size(), "elementwise addition size mismatch: {} != {}\n", size(), values.size());
+            CHECK_DOMAIN_ERROR_IF(size() != values.size(), "elementwise addition size mismatch: {} != {}\n", size(), values.size());
             U const* src = values.begin();
             for (size_type i = 0; i < size(); ++i) at(i) += src[i];
             return ref();
@@ -504,7 +504,7 @@ namespace mz {
         template <typename U>
             requires requires(value_type x, U y) { x -= y; }
         DerivedT& operator-=(std::initializer_list<U> const& values) {
-            DOMAIN_ERROR_IF(size() != values.size(), "elementwise subtraction size mismatch: {} != {}\n", size(), values.size());
+            CHECK_DOMAIN_ERROR_IF(size() != values.size(), "elementwise subtraction size mismatch: {} != {}\n", size(), values.size());
             U const* src = values.begin();
             for (size_type i = 0; i < size(); ++i) at(i) -= src[i];
             return ref();
@@ -516,7 +516,7 @@ namespace mz {
         template <typename U>
             requires requires(value_type x, U y) { x *= y; }
         DerivedT& operator*=(std::initializer_list<U> const& values) {
-            DOMAIN_ERROR_IF(size() != values.size(), "elementwise multiplication size mismatch: {} != {}\n", size(), values.size());
+            CHECK_DOMAIN_ERROR_IF(size() != values.size(), "elementwise multiplication size mismatch: {} != {}\n", size(), values.size());
             U const* src = values.begin();
             for (size_type i = 0; i < size(); ++i) at(i) *= src[i];
             return ref();
@@ -528,7 +528,7 @@ namespace mz {
         template <typename U>
             requires requires(value_type x, U y) { x /= y; }
         DerivedT& operator/=(std::initializer_list<U> const& values) {
-            DOMAIN_ERROR_IF(size() != values.size(), "elementwise division size mismatch: {} != {}\n", size(), values.size());
+            CHECK_DOMAIN_ERROR_IF(size() != values.size(), "elementwise division size mismatch: {} != {}\n", size(), values.size());
             U const* src = values.begin();
             for (size_type i = 0; i < size(); ++i) at(i) /= src[i];
             return ref();
@@ -619,49 +619,49 @@ namespace mz {
 
 		template <Sequence Seq> requires requires(value_type x, typename Seq::value_type y) { x &= y; }
 		Itr& operator &= (Seq it) {
-			DOMAIN_ERROR_IF(size() != it.size(), "elementwise AND size mismatch: {} != {}\n", size(), it.size());
+			CHECK_DOMAIN_ERROR_IF(size() != it.size(), "elementwise AND size mismatch: {} != {}\n", size(), it.size());
 			for (size_type i = 0; i < size(); i++) { at_(i) &= it[i]; }
 			return ref();
 		}
 
 		template <Sequence Seq> requires requires(value_type x, typename Seq::value_type y) { x |= y; }
 		Itr& operator |= (Seq it) {
-			DOMAIN_ERROR_IF(size() != it.size(), "elementwise OR size mismatch: {} != {}\n", size(), it.size());
+			CHECK_DOMAIN_ERROR_IF(size() != it.size(), "elementwise OR size mismatch: {} != {}\n", size(), it.size());
 			for (size_type i = 0; i < size(); i++) { at_(i) |= it[i]; }
 			return ref();
 		}
 
 		template <Sequence Seq> requires requires(value_type x, typename Seq::value_type y) { x ^= y; }
 		Itr& operator ^= (Seq it) {
-			DOMAIN_ERROR_IF(size() != it.size(), "elementwise XOR size mismatch: {} != {}\n", size(), it.size());
+			CHECK_DOMAIN_ERROR_IF(size() != it.size(), "elementwise XOR size mismatch: {} != {}\n", size(), it.size());
 			for (size_type i = 0; i < size(); i++) { at_(i) ^= it[i]; }
 			return ref();
 		}
 
 		template <Sequence Seq> requires requires(value_type x, typename Seq::value_type y) { x += y; }
 		Itr& operator += (Seq it) {
-			DOMAIN_ERROR_IF(size() != it.size(), "elementwise addition size mismatch: {} != {}\n", size(), it.size());
+			CHECK_DOMAIN_ERROR_IF(size() != it.size(), "elementwise addition size mismatch: {} != {}\n", size(), it.size());
 			for (size_type i = 0; i < size(); i++) { at_(i) += it[i]; }
 			return ref();
 		}
 
 		template <Sequence Seq> requires requires(value_type x, typename Seq::value_type y) { x -= y; }
 		Itr& operator -= (Seq it) {
-			DOMAIN_ERROR_IF(size() != it.size(), "elementwise subtraction size mismatch: {} != {}\n", size(), it.size());
+			CHECK_DOMAIN_ERROR_IF(size() != it.size(), "elementwise subtraction size mismatch: {} != {}\n", size(), it.size());
 			for (size_type i = 0; i < size(); i++) { at_(i) -= it[i]; }
 			return ref();
 		}
 
 		template <Sequence Seq> requires requires(value_type x, typename Seq::value_type y) { x *= y; }
 		Itr& operator *= (Seq it) {
-			DOMAIN_ERROR_IF(size() != it.size(), "elementwise multiplication size mismatch: {} != {}\n", size(), it.size());
+			CHECK_DOMAIN_ERROR_IF(size() != it.size(), "elementwise multiplication size mismatch: {} != {}\n", size(), it.size());
 			for (size_type i = 0; i < size(); i++) { at_(i) *= it[i]; }
 			return ref();
 		}
 
 		template <Sequence Seq> requires requires(value_type x, typename Seq::value_type y) { x /= y; }
 		Itr& operator /= (Seq it) {
-			DOMAIN_ERROR_IF(size() != it.size(), "elementwise division size mismatch: {} != {}\n", size(), it.size());
+			CHECK_DOMAIN_ERROR_IF(size() != it.size(), "elementwise division size mismatch: {} != {}\n", size(), it.size());
 			for (size_type i = 0; i < size(); i++) { at_(i) /= it[i]; }
 			return ref();
 		}
@@ -748,7 +748,7 @@ namespace mz {
 		template <typename U>
 		void apply(std::initializer_list<U> const& Li, auto&& Func)
 		{
-			DOMAIN_ERROR_IF(size() != Li.size(), "mz::Span::apply(initializer_list,Fun) size mismatch");
+			CHECK_DOMAIN_ERROR_IF(size() != Li.size(), "mz::Span::apply(initializer_list,Fun) size mismatch");
 			U const* src{ Li.begin() };
 			for (size_type i = 0; i < size(); i++) { Func(at_(i), src[i]); }
 		}
@@ -760,7 +760,7 @@ namespace mz {
 
 		template <typename U> requires requires(value_type x, U y) { x &= y; }
 		Itr& operator &= (std::initializer_list<U> const& li) {
-			DOMAIN_ERROR_IF(size() != li.size(), "elementwise AND size mismatch: {} != {}\n", size(), li.size());
+			CHECK_DOMAIN_ERROR_IF(size() != li.size(), "elementwise AND size mismatch: {} != {}\n", size(), li.size());
 			U const* source = li.begin();
 			for (size_type i = 0; i < size(); i++) { at_(i) &= source[i]; }
 			return ref();
@@ -768,7 +768,7 @@ namespace mz {
 
 		template <typename U> requires requires(value_type x, U y) { x |= y; }
 		Itr& operator |= (std::initializer_list<U> const& li) {
-			DOMAIN_ERROR_IF(size() != li.size(), "elementwise OR size mismatch: {} != {}\n", size(), li.size());
+			CHECK_DOMAIN_ERROR_IF(size() != li.size(), "elementwise OR size mismatch: {} != {}\n", size(), li.size());
 			U const* source = li.begin();
 			for (size_type i = 0; i < size(); i++) { at_(i) |= source[i]; }
 			return ref();
@@ -776,7 +776,7 @@ namespace mz {
 
 		template <typename U> requires requires(value_type x, U y) { x ^= y; }
 		Itr& operator ^= (std::initializer_list<U> const& li) {
-			DOMAIN_ERROR_IF(size() != li.size(), "elementwise XOR size mismatch: {} != {}\n", size(), li.size());
+			CHECK_DOMAIN_ERROR_IF(size() != li.size(), "elementwise XOR size mismatch: {} != {}\n", size(), li.size());
 			U const* source = li.begin();
 			for (size_type i = 0; i < size(); i++) { at_(i) ^= source[i]; }
 			return ref();
@@ -784,7 +784,7 @@ namespace mz {
 
 		template <typename U> requires requires(value_type x, U y) { x += y; }
 		Itr& operator += (std::initializer_list<U> const& li) {
-			DOMAIN_ERROR_IF(size() != li.size(), "elementwise addition size mismatch: {} != {}\n", size(), li.size());
+			CHECK_DOMAIN_ERROR_IF(size() != li.size(), "elementwise addition size mismatch: {} != {}\n", size(), li.size());
 			U const* source = li.begin();
 			for (size_type i = 0; i < size(); i++) { at_(i) += source[i]; }
 			return ref();
@@ -792,7 +792,7 @@ namespace mz {
 
 		template <typename U> requires requires(value_type x, U y) { x -= y; }
 		Itr& operator -= (std::initializer_list<U> const& li) {
-			DOMAIN_ERROR_IF(size() != li.size(), "elementwise subtraction size mismatch: {} != {}\n", size(), li.size());
+			CHECK_DOMAIN_ERROR_IF(size() != li.size(), "elementwise subtraction size mismatch: {} != {}\n", size(), li.size());
 			U const* source = li.begin();
 			for (size_type i = 0; i < size(); i++) { at_(i) -= source[i]; }
 			return ref();
@@ -800,7 +800,7 @@ namespace mz {
 
 		template <typename U> requires requires(value_type x, U y) { x *= y; }
 		Itr& operator *= (std::initializer_list<U> const& li) {
-			DOMAIN_ERROR_IF(size() != li.size(), "elementwise multiplication size mismatch: {} != {}\n", size(), li.size());
+			CHECK_DOMAIN_ERROR_IF(size() != li.size(), "elementwise multiplication size mismatch: {} != {}\n", size(), li.size());
 			U const* source = li.begin();
 			for (size_type i = 0; i < size(); i++) { at_(i) *= source[i]; }
 			return ref();
@@ -808,7 +808,7 @@ namespace mz {
 
 		template <typename U> requires requires(value_type x, U y) { x /= y; }
 		Itr& operator /= (std::initializer_list<U> const& li) {
-			DOMAIN_ERROR_IF(size() != li.size(), "elementwise division size mismatch: {} != {}\n", size(), li.size());
+			CHECK_DOMAIN_ERROR_IF(size() != li.size(), "elementwise division size mismatch: {} != {}\n", size(), li.size());
 			U const* source = li.begin();
 			for (size_type i = 0; i < size(); i++) { at_(i) /= source[i]; }
 			return ref();
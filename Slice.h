@@ -280,7 +280,7 @@ namespace mz {
          */
         Slice& operator = (Slice rhs)
         {
-            DOMAIN_ERROR_IF(size() != rhs.size(), "Slice assignment with Slice of different size: {} != {}\n", size(), rhs.size());
+            CHECK_DOMAIN_ERROR_IF(size() != rhs.size(), "Slice assignment with Slice of different size: {} != {}\n", size(), rhs.size());
             if (std::is_trivially_copyable_v<value_type> && step() == 1 && rhs.step() == 1)
             {
                 memcpy(data(), rhs.data(), sizeof(value_type) * size());
@@ -297,7 +297,7 @@ namespace mz {
          */
         template <Sequence Seq> requires requires (value_type v, typename Seq::value_type s) { v = s; }
         Slice& operator = (Seq rhs) {
-            DOMAIN_ERROR_IF(size() != rhs.size(), "elementwise assignment size mismatch: {} != {}\n", size(), rhs.size());
+            CHECK_DOMAIN_ERROR_IF(size() != rhs.size(), "elementwise assignment size mismatch: {} != {}\n", size(), rhs.size());
             for (size_type i = 0; i < size(); i++) { operator[](i) = rhs[i]; }
             return *this;
         }
@@ -313,7 +313,7 @@ namespace mz {
          */
         template <typename U> requires requires(value_type x, U y) { x = y; }
         Slice& operator = (std::initializer_list<U> const& li) {
-            DOMAIN_ERROR_IF(size() != li.size(), "elementwise assignment size mismatch: {} != {}\n", size(), li.size());
+            CHECK_DOMAIN_ERROR_IF(size() != li.size(), "elementwise assignment size mismatch: {} != {}\n", size(), li.size());
             U const* source = li.begin();
             for (size_type i = 0; i < size(); i++) { operator[](i) = source[i]; }
             return *this;
@@ -557,9 +557,9 @@ bool operator == (mz::Slice<const T> L, mz::Slice<const U> R) noexcept
  * @brief Custom formatter for mz::Slice<T> for std::format integration.
  */
 template<typename T>
-struct std::formatter<mz::Slice<T>> : public mz::basic_formatter16 {
+struct std::formatter<mz::Slice<T>> : public mz::sequence_formatter<std::remove_const_t<T>> {
     auto format(mz::Slice<T> const& p, auto& ctx) const {
-        return std::format_to(ctx.out(), "{}", p.string(std::string_view{ FMT, size_t{count} }));
+        return this->format_sequence(p, ctx);
     }
 };
 
@@ -238,7 +238,7 @@ namespace mz {
 		template <typename Sequence>
 			requires requires (reference a, typename Sequence::reference b) { std::swap(a, b); }
 		void swap_elements(Sequence other) {
-			DOMAIN_ERROR_IF(size_ != other.size(), "Span::swap_elements size mismatch: {} != {}", size_, other.size());
+			CHECK_DOMAIN_ERROR_IF(size_ != other.size(), "Span::swap_elements size mismatch: {} != {}", size_, other.size());
 			swap_elements_unchecked(other);
 		}
 
@@ -271,15 +271,15 @@ namespace mz {
 
 
 		// Safe queue operations (with bounds checking)
-		reference pop_back() { DOMAIN_ERROR_IF(size_ <= 0, "Span::back() empty Span"); return unsafe_pop_back(); }
-		reference pop_front() { DOMAIN_ERROR_IF(size_ <= 0, "Span::back() empty Span"); return unsafe_pop_front(); }
-		Span pop_back(std::integral auto Count) { DOMAIN_ERROR_IF(size_ < Count, "Span::back() empty Span"); return unsafe_pop_back(Count); }
-		Span pop_front(std::integral auto Count) { DOMAIN_ERROR_IF(size_ < Count, "Span::back() empty Span"); return unsafe_pop_front(Count); }
+		reference pop_back() { CHECK_DOMAIN_ERROR_IF(size_ <= 0, "Span::back() empty Span"); return unsafe_pop_back(); }
+		reference pop_front() { CHECK_DOMAIN_ERROR_IF(size_ <= 0, "Span::back() empty Span"); return unsafe_pop_front(); }
+		Span pop_back(std::integral auto Count) { CHECK_DOMAIN_ERROR_IF(size_ < Count, "Span::back() empty Span"); return unsafe_pop_back(Count); }
+		Span pop_front(std::integral auto Count) { CHECK_DOMAIN_ERROR_IF(size_ < Count, "Span::back() empty Span"); return unsafe_pop_front(Count); }
 
-		reference back() { DOMAIN_ERROR_IF(size_ <= 0, "Span::back() empty Span"); return unsafe_back(); }
-		reference front() { DOMAIN_ERROR_IF(size_ <= 0, "Span::back() empty Span"); return unsafe_front(); }
-		Span back(std::integral auto Count) { DOMAIN_ERROR_IF(size_ < Count, "Span::back({}) overflow", Count); return const_cast<Span*>(this)->back(Count); }
-		Span front(std::integral auto Count) { DOMAIN_ERROR_IF(size_ < Count, "Span::front({}) overflow", Count); return const_cast<Span*>(this)->front(Count); }
+		reference back() { CHECK_DOMAIN_ERROR_IF(size_ <= 0, "Span::back() empty Span"); return unsafe_back(); }
+		reference front() { CHECK_DOMAIN_ERROR_IF(size_ <= 0, "Span::back() empty Span"); return unsafe_front(); }
+		Span back(std::integral auto Count) { CHECK_DOMAIN_ERROR_IF(size_ < Count, "Span::back({}) overflow", Count); return const_cast<Span*>(this)->back(Count); }
+		Span front(std::integral auto Count) { CHECK_DOMAIN_ERROR_IF(size_ < Count, "Span::front({}) overflow", Count); return const_cast<Span*>(this)->front(Count); }
 
 		const_reference back() const { return const_cast<Span*>(this)->back(); }
 		const_reference front() const { return const_cast<Span*>(this)->front(); }
@@ -356,7 +356,7 @@ namespace mz {
 		template <Sequence Seq> 
 			requires requires (value_type v, typename Seq::value_type s) { v = s; }
 		Span& operator = (Seq rhs) {
-			DOMAIN_ERROR_IF(size() != rhs.size(), "elementwise assignment size mismatch: {} != {}\n", size(), rhs.size());
+			CHECK_DOMAIN_ERROR_IF(size() != rhs.size(), "elementwise assignment size mismatch: {} != {}\n", size(), rhs.size());
 			for (size_type i = 0; i < size(); i++) { data_[i] = rhs[i]; }
 			return *this;
 		}
@@ -367,7 +367,7 @@ namespace mz {
 		 */
 		Span& operator = (Span rhs)
 		{
-			DOMAIN_ERROR_IF(size() != rhs.size(), "Span assignment with Span of different size: {} != {}\n", size(), rhs.size());
+			CHECK_DOMAIN_ERROR_IF(size() != rhs.size(), "Span assignment with Span of different size: {} != {}\n", size(), rhs.size());
 			if (std::is_trivially_copyable_v<value_type>)
 			{
 				memcpy(begin(), rhs.begin(), sizeof(value_type) * size());
@@ -395,7 +395,7 @@ namespace mz {
 		 */
 		template <typename U> requires requires(value_type x, U y) { x = y; }
 		Span& operator = (std::initializer_list<U> const& li) {
-			DOMAIN_ERROR_IF(size() != li.size(), "elementwise assignment size mismatch: {} != {}\n", size(), li.size());
+			CHECK_DOMAIN_ERROR_IF(size() != li.size(), "elementwise assignment size mismatch: {} != {}\n", size(), li.size());
 			U const* source = li.begin();
 			for (size_type i = 0; i < size(); i++) { operator[](i) = source[i]; }
 			return *this;
@@ -602,9 +602,9 @@ size_type count(mz::Span<T> bf) {
  * @brief Custom formatter for mz::Span<T> for std::format integration.
  */
 template<typename T>
-struct std::formatter<mz::Span<T>> : public mz::basic_formatter16 {
+struct std::formatter<mz::Span<T>> : public mz::sequence_formatter<std::remove_const_t<T>> {
 	auto format(mz::Span<T> const& p, auto& ctx) const {
-		return std::format_to(ctx.out(), "{}", p.string(std::string_view{ FMT, size_t{count} }));
+		return this->format_sequence(p, ctx);
 	}
 };
 
@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <cstring>
 #include "globals.h"
+#include "alloc_utils.h"
 
 /**
  * @file Stack.h
@@ -90,6 +91,7 @@ namespace mz {
          */
         void resize_in_place() noexcept {
             Stack temp(m_cap * 2 + 2);
+            if (m_size) alloc_stats::on_grow<pointer>(sizeof(pointer) * m_size);
             temp.m_size = m_size;
             std::memcpy(temp.m_data, m_data, sizeof(pointer) * m_size);
             swap(*this, temp);
@@ -108,12 +110,13 @@ namespace mz {
          */
         explicit Stack(size_type capacity)
             : m_data{ new pointer[capacity] }, m_size{ 0 }, m_cap{ capacity } {
+            alloc_stats::on_allocate<pointer>(sizeof(pointer) * capacity);
         }
 
         /**
          * @brief Destructor. Deletes the internal pointer array.
          */
-        ~Stack() { delete[] m_data; }
+        ~Stack() { alloc_stats::on_release<pointer>(m_data); delete[] m_data; }
 
         // --- Capacity and Size ---
 
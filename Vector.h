@@ -29,8 +29,10 @@
 #include <algorithm>
 #include "globals.h"
 #include "zstream.h"
+#include "zencoding.h"
 #include "Span.h"
 #include "Slice.h"
+#include "alloc_utils.h"
 
 
 
@@ -100,7 +102,7 @@ namespace mz {
 		/**
 		 * @brief Destructor. Releases memory.
 		 */
-		constexpr ~Vector() noexcept { delete[] m_data; m_data = nullptr; m_size = 0; m_cap = 0; }
+		constexpr ~Vector() noexcept { alloc_stats::on_release<value_type>(m_data); delete[] m_data; m_data = nullptr; m_size = 0; m_cap = 0; }
 
 		/**
 		 * @brief Default constructor. Empty vector.
@@ -116,6 +118,7 @@ namespace mz {
 			m_data{ new value_type[Capacity] },
 			m_size{ static_cast<size_type>(Size) },
 			m_cap{ static_cast<size_type>(Capacity) } {
+			alloc_stats::on_allocate<value_type>(sizeof(value_type) * m_cap);
 		}
 
 		/**
@@ -138,6 +141,7 @@ namespace mz {
 			m_size{ rhs.m_size },
 			m_cap{ rhs.m_size }
 		{
+			alloc_stats::on_allocate<value_type>(sizeof(value_type) * m_cap);
 			for (size_type i = 0; i < m_size; i++) m_data[i] = rhs.m_data[i];
 		}
 
@@ -163,7 +167,9 @@ namespace mz {
 			long long NewCapacity = Capacity;
 			if (OldCapacity < NewCapacity) {
 				pointer Ptr = new value_type[NewCapacity];
+				alloc_stats::on_allocate<value_type>(sizeof(value_type) * NewCapacity);
 				if (KeepExistingData && m_size > 0) {
+					alloc_stats::on_grow<value_type>(sizeof(value_type) * m_size);
 					if constexpr (std::is_trivially_copyable_v<value_type>) {
 						memcpy(Ptr, m_data, sizeof(value_type) * m_size);
 					}
@@ -176,6 +182,7 @@ namespace mz {
 				}
 				std::swap(Ptr, m_data);
 				m_cap = static_cast<size_type>(NewCapacity);
+				alloc_stats::on_release<value_type>(Ptr);
 				delete[] Ptr;
 			}
 		}
@@ -184,8 +191,8 @@ namespace mz {
 		 * @brief Reserve extra capacity.
 		 */
 		void reserve_extra(INDEX_T ExtraCapacity) {
-			DOMAIN_ERROR_IF(m_size < 0, "Vector::reserve_extra: size = {} < 0", m_size);
-			DOMAIN_ERROR_IF(m_size > m_cap, "Vector::reserve_extra: size = {} > capacity = {}", m_size, m_cap);
+			CHECK_DOMAIN_ERROR_IF(m_size < 0, "Vector::reserve_extra: size = {} < 0", m_size);
+			CHECK_DOMAIN_ERROR_IF(m_size > m_cap, "Vector::reserve_extra: size = {} > capacity = {}", m_size, m_cap);
 			reserve(m_size + ExtraCapacity, true);
 		}
 
@@ -197,8 +204,10 @@ namespace mz {
 			long long NewCapacity = Capacity;
 			if (OldCapacity < NewCapacity) {
 				pointer Ptr = new value_type[NewCapacity];
+				alloc_stats::on_allocate<value_type>(sizeof(value_type) * NewCapacity);
 				std::swap(Ptr, m_data);
 				m_cap = static_cast<size_type>(NewCapacity);
+				alloc_stats::on_release<value_type>(Ptr);
 				delete[] Ptr;
 			}
 			m_size = 0;
@@ -212,8 +221,10 @@ namespace mz {
 			long long NewCapacity = Capacity;
 			if (OldCapacity < NewCapacity) {
 				pointer Ptr = new value_type[NewCapacity];
+				alloc_stats::on_allocate<value_type>(sizeof(value_type) * NewCapacity);
 				std::swap(Ptr, m_data);
 				m_cap = static_cast<size_type>(NewCapacity);
+				alloc_stats::on_release<value_type>(Ptr);
 				delete[] Ptr;
 			}
 			m_size = static_cast<size_type>(Capacity);
@@ -251,6 +262,7 @@ namespace mz {
 		void enlarge() noexcept {
 			if (m_size == m_cap) {
 				auto new_cap = m_cap ? m_cap * 2 : 2;
+				alloc_stats::on_enlarge<value_type>();
 				reserve(new_cap, true);
 			}
 		}
@@ -261,6 +273,8 @@ namespace mz {
 		void shrink_to_fit() noexcept {
 			if (m_size < m_cap) {
 				pointer Ptr = new value_type[m_size];
+				alloc_stats::on_allocate<value_type>(sizeof(value_type) * m_size);
+				alloc_stats::on_shrink<value_type>(sizeof(value_type) * m_size);
 				if constexpr (std::is_trivially_copyable_v<value_type>) {
 					memcpy(Ptr, m_data, sizeof(value_type) * m_size);
 				}
@@ -269,6 +283,7 @@ namespace mz {
 				}
 				std::swap(m_data, Ptr);
 				m_cap = m_size;
+				alloc_stats::on_release<value_type>(Ptr);
 				delete[] Ptr;
 			}
 		}
@@ -286,6 +301,7 @@ namespace mz {
 			m_size{ static_cast<size_type>(rhs.size()) },
 			m_cap{ static_cast<size_type>(rhs.size()) }
 		{
+			alloc_stats::on_allocate<value_type>(sizeof(value_type) * m_cap);
 			for (size_type i = 0; i < m_size; i++) { m_data[i] = rhs[i]; }
 		};
 
@@ -408,14 +424,14 @@ namespace mz {
 		/**
 		 * @brief Access last element (throws if empty).
 		 */
-		reference back() { DOMAIN_ERROR_IF(m_size < 1, "empty Vector::back()"); return unsafe_back(); }
-		const_reference back() const { DOMAIN_ERROR_IF(m_size < 1, "empty Vector::back()"); return unsafe_back(); }
+		reference back() { CHECK_DOMAIN_ERROR_IF(m_size < 1, "empty Vector::back()"); return unsafe_back(); }
+		const_reference back() const { CHECK_DOMAIN_ERROR_IF(m_size < 1, "empty Vector::back()"); return unsafe_back(); }
 
 		/**
 		 * @brief Access first element (throws if empty).
 		 */
-		reference front() { DOMAIN_ERROR_IF(m_size < 1, "empty Vector::front()"); return unsafe_front(); }
-		const_reference front() const { DOMAIN_ERROR_IF(m_size < 1, "empty Vector::front()"); return unsafe_front(); }
+		reference front() { CHECK_DOMAIN_ERROR_IF(m_size < 1, "empty Vector::front()"); return unsafe_front(); }
+		const_reference front() const { CHECK_DOMAIN_ERROR_IF(m_size < 1, "empty Vector::front()"); return unsafe_front(); }
 
 		/**
 		 * @brief Access element by index (throws if out of range).
@@ -434,7 +450,7 @@ namespace mz {
 		/**
 		 * @brief Remove and return last element, throws if empty.
 		 */
-		value_type pop_back() { DOMAIN_ERROR_IF(m_size < 1, "empty Vector::pop_back()"); return std::move(m_data[--m_size]); }
+		value_type pop_back() { CHECK_DOMAIN_ERROR_IF(m_size < 1, "empty Vector::pop_back()"); return std::move(m_data[--m_size]); }
 
 		/**
 		 * @brief Add element to end, undefined if capacity exceeded (use enlarge() or push_back() to ensure capacity).
@@ -488,7 +504,7 @@ namespace mz {
 		template <IntegralSequence Seq>
 		Vector operator[](Seq it) const noexcept
 		{
-			Vector Res(size_type(it.size()));
+			Vector Res(size_type(it.size()), size_type(it.size()));
 			for (size_type i = 0; i < it.size(); i++) { Res[i] = m_data[it[i]]; }
 			return Res;
 		}
@@ -501,7 +517,7 @@ namespace mz {
 		{
 			INVALID_ARGUMENT_IF(it.size() != size(), "Vector::[] boolean selector length difference {} != {}\n", it.size(), size());
 			size_type Count = count(it);
-			Vector Res(Count);
+			Vector Res(Count, 0);
 			Res.expand_to_capacity();
 			pointer Ptr{ Res.data() };
 			for (size_type i = 0; i < it.size(); i++) { if (it[i]) { *Ptr++ = m_data[i]; } }
@@ -516,7 +532,8 @@ namespace mz {
 		void save(mz::Stream& ss) const noexcept
 			requires requires(mz::Stream& ss, const_reference x) { ss << x; } {
 			ss << size_type(m_size);
-			for (size_type i = 0; i < m_size; i++) ss << m_data[i];
+			if constexpr (std::is_trivially_copyable_v<value_type>) { ss.write(m_data, m_size); }
+			else { for (size_type i = 0; i < m_size; i++) ss << m_data[i]; }
 		}
 
 		void load(mz::Stream& ss) noexcept
@@ -524,7 +541,8 @@ namespace mz {
 			size_type L;
 			ss >> L;
 			resize(L, false);
-			for (size_type i = 0; i < L; i++) ss >> m_data[i];
+			if constexpr (std::is_trivially_copyable_v<value_type>) { ss.read(m_data, L); }
+			else { for (size_type i = 0; i < L; i++) ss >> m_data[i]; }
 		}
 
 
@@ -565,7 +583,8 @@ namespace mz {
 			size_type L;
 			s >> L;
 			resize(L, false);
-			for (size_type i = 0; i < L; i++) { s >> m_data[i]; }
+			if constexpr (std::is_trivially_copyable_v<value_type>) { s.read(m_data, L); }
+			else { for (size_type i = 0; i < L; i++) { s >> m_data[i]; } }
 
 			if (s.read_label(Enc)) return true;
 
@@ -588,11 +607,34 @@ namespace mz {
 			s.write_label(Enc);
 			size_type L = size();
 			s << L;
-			for (size_type i = 0; i < L; i++) { s << m_data[i]; }
+			if constexpr (std::is_trivially_copyable_v<value_type>) { s.write(m_data, L); }
+			else { for (size_type i = 0; i < L; i++) { s << m_data[i]; } }
 			s.write_label(Enc);
 		}
 
 
+		/**
+		 * @brief Saves an integral vector as a compact encoded block (see zencoding.h).
+		 *
+		 * The block is labelled with the encoding and element width, so load_encoded
+		 * needs no extra arguments. Sorted ids compress best with delta or stream_vbyte.
+		 */
+		void save_encoded(mz::Stream& s, IntEncoding encoding) const noexcept
+			requires std::integral<value_type> {
+			write_integers(s, m_data, m_size, encoding);
+		}
+
+
+		/**
+		 * @brief Loads a vector written by save_encoded.
+		 * @return true on error (label mismatch or corrupt payload), false on success.
+		 */
+		bool load_encoded(mz::Stream& s) noexcept
+			requires std::integral<value_type> {
+			return read_integers<value_type>(s, [this](size_type n) { resize(n, false); return m_data; });
+		}
+
+
 
 
 
@@ -809,9 +851,9 @@ struct LOADER {
 
 
 template<typename T>
-struct std::formatter<mz::Vector<T>> : public mz::basic_formatter16 {
+struct std::formatter<mz::Vector<T>> : public mz::sequence_formatter<T> {
 	auto format(mz::Vector<T> const& p, auto& ctx) const {
-		return std::format_to(ctx.out(), "{}", p.string(std::string_view{ FMT, size_t{count} }));
+		return this->format_sequence(p, ctx);
 	}
 };
 
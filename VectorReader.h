@@ -0,0 +1,274 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_VECTOR_READER_HEADER_FILE
+#define MZ_VECTOR_READER_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include "globals.h"
+#include "zstream.h"
+#include "zmmap.h"
+#include "Vector.h"
+#include "Span.h"
+
+/**
+ * @file VectorReader.h
+ * @brief Block-wise streaming of Vectors that need not fit in memory.
+ *
+ * This header defines:
+ *   - mz::VectorFormat: the on-disk form produced by Vector::save (size header only)
+ *     or Vector::save3 (size header between labels).
+ *   - mz::VectorReader: pulls the elements of a saved Vector in fixed-size blocks.
+ *   - mz::VectorWriter: pushes elements in blocks and patches the size header on close.
+ *
+ * Both sides produce and consume exactly the bytes of save/save3 and load/load3, so a
+ * file written with VectorWriter loads with Vector::load and vice versa, while memory
+ * use stays at one block. Reading from an MmapStream yields windows straight into the
+ * mapping and releases the pages already consumed, so resident memory is bounded as well.
+ * The size header is a size_type, so one Vector holds at most INT_MAX elements; larger
+ * data sets are a sequence of such Vectors.
+ *
+ * Usage example:
+ *   mz::FileStream fs("samples.bin");
+ *   mz::VectorReader<double> reader(fs, 1 << 20);
+ *   double sum = 0;
+ *   for (auto block = reader.next(); !block.empty(); block = reader.next())
+ *       for (double x : block) sum += x;
+ *   if (reader.finish()) { ... }                  // true on error, like load3
+ *
+ *   mz::VectorWriter<double> writer(out, mz::VectorFormat::save3, TypeId);
+ *   for (...) writer.push(x);
+ *   writer.close();                               // patches the element count
+ */
+
+namespace mz {
+
+    enum class VectorFormat : uint8_t { save, save3 };
+
+    /**
+     * @brief Reads a saved Vector<T> one block at a time.
+     *
+     * Each block returned by next() is valid until the following call to next().
+     */
+    template <typename T>
+        requires(std::is_trivially_copyable_v<T>)
+    class VectorReader {
+        Stream& stream_;
+        MmapStream* mapped_;              // non-null when windows can point into a mapping
+        Vector<T> buffer_;
+        size_type block_;
+        size_type size_ = 0;
+        size_type remaining_ = 0;
+        size_t released_ = 0;             // mapping offset below which pages were released
+        VectorFormat format_;
+        uint64_t enc_;
+        bool failed_ = false;
+        bool finished_ = false;
+
+    public:
+        /**
+         * @brief Reads the header (labels and element count) at the stream's read position.
+         * @param block_elements Maximum number of elements per block.
+         */
+        explicit VectorReader(Stream& s, size_type block_elements = 1 << 16, VectorFormat format = VectorFormat::save, uint64_t Enc = 0) noexcept
+            : stream_(s), mapped_(dynamic_cast<MmapStream*>(&s)), block_(std::max<size_type>(block_elements, 1)), format_(format), enc_(Enc) {
+            if (format_ == VectorFormat::save3 && stream_.read_label(enc_)) { failed_ = true; return; }
+            stream_ >> size_;
+            if (size_ < 0 || stream_.failed()) { failed_ = true; size_ = 0; return; }
+            remaining_ = size_;
+            if (mapped_) {
+                released_ = mapped_->position();
+                mapped_->advise(released_, sizeof(T) * static_cast<size_t>(size_), MmapAdvice::sequential);
+            }
+            else {
+                buffer_.resize(std::min(block_, size_), false);
+            }
+        }
+
+        VectorReader(VectorReader const&) = delete;
+        VectorReader& operator=(VectorReader const&) = delete;
+
+        // Total number of elements in the saved Vector
+        size_type size() const noexcept { return size_; }
+
+        // Elements not yet returned by next()
+        size_type remaining() const noexcept { return remaining_; }
+
+        size_type block_size() const noexcept { return block_; }
+
+        bool failed() const noexcept { return failed_; }
+
+        /**
+         * @brief Returns the next block of at most block_size() elements; empty at the end or on error.
+         */
+        Span<const T> next() noexcept {
+            if (failed_ || remaining_ == 0) return {};
+            size_type const count = std::min(block_, remaining_);
+            size_t const bytes = sizeof(T) * static_cast<size_t>(count);
+            if (mapped_ && reinterpret_cast<uintptr_t>(mapped_->bytes().data() + mapped_->position()) % alignof(T) == 0) {
+                if (mapped_->remaining() < bytes) { failed_ = true; return {}; }
+                size_t const start = mapped_->position();
+                if (start > released_) {
+                    mapped_->advise(released_, start - released_, MmapAdvice::dontneed);
+                    released_ = start;
+                }
+                remaining_ -= count;
+                return mapped_->read_span<T>(count);
+            }
+            if (buffer_.size() < count) buffer_.resize(count, false);
+            stream_.read(buffer_.data(), count);
+            if (stream_.failed()) { failed_ = true; return {}; }
+            remaining_ -= count;
+            return Span<const T>(buffer_.data(), count);
+        }
+
+        /**
+         * @brief Applies f to every remaining block, then finishes.
+         * @return true on error, like Vector::load3.
+         */
+        template <typename F>
+            requires requires(F&& f, Span<const T> block) { f(block); }
+        bool for_each(F&& f) {
+            for (auto block = next(); !block.empty(); block = next()) f(block);
+            return finish();
+        }
+
+        /**
+         * @brief Skips unread elements and consumes the closing label (save3).
+         *
+         * Leaves the stream positioned after the Vector, as load/load3 would.
+         * @return true on error.
+         */
+        bool finish() noexcept {
+            if (finished_ || failed_) return failed_;
+            finished_ = true;
+            if (remaining_) {
+                int64_t const here = stream_.tell();
+                int64_t const skip = static_cast<int64_t>(sizeof(T)) * remaining_;
+                if (here < 0 || !stream_.seek(here + skip)) {
+                    while (!failed_ && remaining_) next();
+                }
+                remaining_ = 0;
+            }
+            if (!failed_ && format_ == VectorFormat::save3 && stream_.read_label(enc_)) failed_ = true;
+            return failed_;
+        }
+    };
+
+    /**
+     * @brief Writes a Vector<T> incrementally in the format of Vector::save/save3.
+     *
+     * The element count is written as a placeholder and patched in close(), which needs a
+     * stream that supports overwrite(); when the count is known up front it is written
+     * directly and close() only checks it, so any stream works.
+     */
+    template <typename T>
+        requires(std::is_trivially_copyable_v<T>)
+    class VectorWriter {
+        Stream& stream_;
+        Vector<T> buffer_;
+        size_type used_ = 0;
+        size_type count_ = 0;
+        size_type expected_;
+        int64_t header_ = -1;             // offset of the size header to patch
+        VectorFormat format_;
+        uint64_t enc_;
+        bool open_ = true;
+        bool failed_ = false;
+
+        void flush_block() noexcept {
+            if (used_) stream_.write(buffer_.data(), used_);
+            used_ = 0;
+        }
+
+    public:
+        /**
+         * @param count Number of elements that will be written, or -1 to patch the header on close.
+         * @throws std::domain_error if count is -1 and the stream cannot overwrite written bytes.
+         */
+        explicit VectorWriter(Stream& s, VectorFormat format = VectorFormat::save, uint64_t Enc = 0, size_type block_elements = 1 << 16, size_type count = -1)
+            : stream_(s), expected_(count), format_(format), enc_(Enc) {
+            buffer_.resize(std::max<size_type>(block_elements, 1), false);
+            if (format_ == VectorFormat::save3) stream_.write_label(enc_);
+            if (expected_ < 0) {
+                header_ = stream_.write_position();
+                DOMAIN_ERROR_IF(header_ < 0, "VectorWriter: the stream cannot patch the size header; pass the element count");
+            }
+            stream_ << size_type(expected_ < 0 ? 0 : expected_);
+        }
+
+        ~VectorWriter() { close(); }
+
+        VectorWriter(VectorWriter const&) = delete;
+        VectorWriter& operator=(VectorWriter const&) = delete;
+
+        // Elements written so far
+        size_type size() const noexcept { return count_; }
+
+        bool failed() const noexcept { return failed_ || stream_.failed(); }
+
+        void push(const T& x) noexcept {
+            if (count_ == INT_MAX || !open_) { failed_ = true; return; }
+            if (used_ == buffer_.size()) flush_block();
+            buffer_[used_++] = x;
+            count_++;
+        }
+
+        /**
+         * @brief Appends a run of elements; runs of at least one block bypass the buffer.
+         */
+        void append(Span<const T> values) noexcept {
+            if (!open_ || values.size() > INT_MAX - count_) { failed_ = true; return; }
+            if (values.size() >= buffer_.size()) {
+                flush_block();
+                stream_.write(values.data(), values.size());
+                count_ += values.size();
+                return;
+            }
+            for (size_type i = 0; i < values.size(); i++) push(values[i]);
+        }
+
+        /**
+         * @brief Writes pending elements, sets the size header and the closing label (save3).
+         *
+         * The stream stays open and positioned after the Vector.
+         */
+        void close() noexcept {
+            if (!open_) return;
+            open_ = false;
+            flush_block();
+            if (header_ >= 0) {
+                if (!stream_.overwrite(header_, reinterpret_cast<const char*>(&count_), sizeof(count_))) failed_ = true;
+            }
+            else if (count_ != expected_) {
+                failed_ = true;
+            }
+            if (format_ == VectorFormat::save3) stream_.write_label(enc_);
+        }
+    };
+
+} // namespace mz
+
+#endif // MZ_VECTOR_READER_HEADER_FILE
@@ -0,0 +1,363 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef MZ_ALLOC_UTILS_HEADER_FILE
+#define MZ_ALLOC_UTILS_HEADER_FILE
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <source_location>
+#include <type_traits>
+#include <format>
+#include <cstdio>
+
+/**
+ * @file alloc_utils.h
+ * @brief Optional allocation and copy instrumentation for the growth paths of mz containers.
+ *
+ * This header defines:
+ *   - MZ_ALLOC_STATS: define to 1 before including any mz header to enable instrumentation.
+ *   - mz::alloc_stats::on_allocate / on_grow / on_enlarge / on_shrink / on_release:
+ *       hooks called by Vector and Stack; empty constexpr functions when disabled.
+ *   - mz::AllocTypeStats: per-element-type totals (allocations, reallocations, bytes copied, ...).
+ *   - mz::alloc_report(): snapshot of all threads, sorted by bytes copied during growth.
+ *   - mz::alloc_report_string(), mz::print_alloc_report(), mz::alloc_reset().
+ *
+ * Counters are kept per thread and per element type. The owning thread updates its own
+ * slots with relaxed load/store pairs (no locked read-modify-write), so the hot path never
+ * contends. The registry mutex is only taken when a thread records its first event, when
+ * it exits (its counters are folded into the retired totals) and when a report is taken.
+ * Reports taken while other threads are still allocating are approximate.
+ *
+ * Usage example:
+ *   #define MZ_ALLOC_STATS 1
+ *   #include "Vector.h"
+ *   mz::Vector<int> v;
+ *   for (int i = 0; i < 1000; ++i) v.push_back(i);  // regrows through enlarge()
+ *   mz::print_alloc_report();
+ */
+
+#ifndef MZ_ALLOC_STATS
+#define MZ_ALLOC_STATS 0
+#endif
+
+namespace mz {
+
+    /**
+     * @brief Totals for one element type, summed over all threads.
+     */
+    struct AllocTypeStats {
+        std::string type;                 ///< Element type name.
+        size_t element_size = 0;          ///< sizeof(element type).
+        uint64_t allocations = 0;         ///< Buffers allocated (any reason).
+        uint64_t reallocations = 0;       ///< Growths that kept existing data (reserve/enlarge).
+        uint64_t enlarges = 0;            ///< Growths triggered by enlarge() (push without reserve).
+        uint64_t shrinks = 0;             ///< shrink_to_fit calls that reallocated.
+        uint64_t releases = 0;            ///< Buffers freed.
+        uint64_t bytes_allocated = 0;     ///< Sum of allocated buffer sizes.
+        uint64_t bytes_copied = 0;        ///< Bytes copied into new buffers while growing or shrinking.
+        uint64_t peak_capacity_bytes = 0; ///< Largest single buffer allocated.
+    };
+
+    namespace alloc_stats {
+
+        /// True when instrumentation is compiled in.
+        inline constexpr bool enabled = MZ_ALLOC_STATS != 0;
+
+        /// Maximum number of distinct element types that can be tracked.
+        inline constexpr size_t max_types = 256;
+
+        /**
+         * @brief Compiler-provided name of T, e.g. "int" or "mz::Vector<double>".
+         */
+        template <typename T>
+        constexpr std::string_view type_name() noexcept {
+            std::string_view name = std::source_location::current().function_name();
+#if defined(_MSC_VER) && !defined(__clang__)
+            auto first = name.find("type_name<") + 10;
+            auto last = name.rfind(">(");
+#else
+            auto first = name.find("T = ") + 4;
+            auto last = name.find_first_of(";]", first);
+#endif
+            if (first >= name.size() || last == std::string_view::npos || last < first) return name;
+            return name.substr(first, last - first);
+        }
+
+        namespace detail {
+
+            enum Counter : size_t {
+                c_allocations, c_reallocations, c_enlarges, c_shrinks, c_releases,
+                c_bytes_allocated, c_bytes_copied, c_peak_capacity, c_count
+            };
+
+            struct Slot {
+                std::atomic<uint64_t> value[c_count]{};
+
+                void add(Counter c, uint64_t n) noexcept {
+                    value[c].store(value[c].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+                }
+                void raise(Counter c, uint64_t n) noexcept {
+                    if (n > value[c].load(std::memory_order_relaxed)) value[c].store(n, std::memory_order_relaxed);
+                }
+            };
+
+            struct TypeInfo {
+                std::string_view name;
+                size_t size = 0;
+            };
+
+            struct ThreadBlock;
+
+            struct Registry {
+                std::mutex mutex;
+                std::vector<ThreadBlock*> threads;
+                std::atomic<size_t> type_count{ 0 };
+                TypeInfo types[max_types];
+                uint64_t retired[max_types][c_count]{};
+
+                static Registry& instance() {
+                    static Registry& registry = *new Registry;    // never destroyed: static objects may release late
+                    return registry;
+                }
+            };
+
+            // True once the calling thread's block is destroyed; the main thread's goes before
+            // objects with static storage duration, which may still release buffers
+            inline bool& block_gone() noexcept {
+                thread_local bool gone = false;
+                return gone;
+            }
+
+            struct ThreadBlock {
+                Slot slots[max_types];
+
+                ThreadBlock() {
+                    auto& r = Registry::instance();
+                    std::lock_guard lock(r.mutex);
+                    r.threads.push_back(this);
+                }
+
+                ~ThreadBlock() {
+                    auto& r = Registry::instance();
+                    std::lock_guard lock(r.mutex);
+                    for (size_t t = 0; t < max_types; ++t) {
+                        for (size_t c = 0; c < c_count; ++c) {
+                            auto v = slots[t].value[c].load(std::memory_order_relaxed);
+                            if (c == c_peak_capacity) r.retired[t][c] = (std::max)(r.retired[t][c], v);
+                            else r.retired[t][c] += v;
+                        }
+                    }
+                    std::erase(r.threads, this);
+                    block_gone() = true;
+                }
+            };
+
+            inline size_t register_type(std::string_view name, size_t size) noexcept {
+                auto& r = Registry::instance();
+                std::lock_guard lock(r.mutex);
+                auto n = r.type_count.load(std::memory_order_relaxed);
+                if (n == max_types) return max_types - 1; // overflow types share the last slot
+                r.types[n] = { n == max_types - 1 ? std::string_view("<other>") : name, size };
+                r.type_count.store(n + 1, std::memory_order_release);
+                return n;
+            }
+
+            template <typename T>
+            size_t type_slot() noexcept {
+                static const size_t slot = register_type(type_name<T>(), sizeof(T));
+                return slot;
+            }
+
+            // One counter block per thread, shared by every element type
+            inline ThreadBlock& thread_block() noexcept {
+                thread_local ThreadBlock block;
+                return block;
+            }
+
+            // Adds n to counter c of type slot t (or raises it to n for c_peak_capacity)
+            inline void count(size_t t, Counter c, uint64_t n) noexcept {
+                if (!block_gone()) {
+                    Slot& s = thread_block().slots[t];
+                    if (c == c_peak_capacity) s.raise(c, n);
+                    else s.add(c, n);
+                    return;
+                }
+                auto& r = Registry::instance();
+                std::lock_guard lock(r.mutex);
+                if (c == c_peak_capacity) r.retired[t][c] = (std::max)(r.retired[t][c], n);
+                else r.retired[t][c] += n;
+            }
+
+        } // namespace detail
+
+        /**
+         * @brief Records allocation of a buffer of @p bytes holding elements of type T.
+         */
+        template <typename T>
+        constexpr void on_allocate(size_t bytes) noexcept {
+            if constexpr (enabled) {
+                if (std::is_constant_evaluated()) return;
+                size_t const t = detail::type_slot<T>();
+                detail::count(t, detail::c_allocations, 1);
+                detail::count(t, detail::c_bytes_allocated, bytes);
+                detail::count(t, detail::c_peak_capacity, bytes);
+            }
+        }
+
+        /**
+         * @brief Records a growth that moved @p copied_bytes of existing data into a new buffer.
+         */
+        template <typename T>
+        constexpr void on_grow(size_t copied_bytes) noexcept {
+            if constexpr (enabled) {
+                if (std::is_constant_evaluated()) return;
+                size_t const t = detail::type_slot<T>();
+                detail::count(t, detail::c_reallocations, 1);
+                detail::count(t, detail::c_bytes_copied, copied_bytes);
+            }
+        }
+
+        /**
+         * @brief Records that a growth was triggered by enlarge() rather than an explicit reserve.
+         */
+        template <typename T>
+        constexpr void on_enlarge() noexcept {
+            if constexpr (enabled) {
+                if (std::is_constant_evaluated()) return;
+                detail::count(detail::type_slot<T>(), detail::c_enlarges, 1);
+            }
+        }
+
+        /**
+         * @brief Records a shrink_to_fit that copied @p copied_bytes into a smaller buffer.
+         */
+        template <typename T>
+        constexpr void on_shrink(size_t copied_bytes) noexcept {
+            if constexpr (enabled) {
+                if (std::is_constant_evaluated()) return;
+                size_t const t = detail::type_slot<T>();
+                detail::count(t, detail::c_shrinks, 1);
+                detail::count(t, detail::c_bytes_copied, copied_bytes);
+            }
+        }
+
+        /**
+         * @brief Records that a buffer was freed.
+         */
+        template <typename T>
+        constexpr void on_release(const void* ptr) noexcept {
+            if constexpr (enabled) {
+                if (std::is_constant_evaluated() || !ptr) return;
+                detail::count(detail::type_slot<T>(), detail::c_releases, 1);
+            }
+        }
+
+    } // namespace alloc_stats
+
+    /**
+     * @brief Snapshot of the allocation counters of all threads (live and exited), one entry per
+     *        element type that recorded at least one event, sorted by bytes copied (descending).
+     *        Returns an empty vector when MZ_ALLOC_STATS is off.
+     */
+    inline std::vector<AllocTypeStats> alloc_report() {
+        std::vector<AllocTypeStats> result;
+        if constexpr (alloc_stats::enabled) {
+            using namespace alloc_stats::detail;
+            auto& r = Registry::instance();
+            std::lock_guard lock(r.mutex);
+            auto n = r.type_count.load(std::memory_order_acquire);
+            for (size_t t = 0; t < n; ++t) {
+                uint64_t v[c_count];
+                for (size_t c = 0; c < c_count; ++c) v[c] = r.retired[t][c];
+                for (auto* block : r.threads) {
+                    for (size_t c = 0; c < c_count; ++c) {
+                        auto x = block->slots[t].value[c].load(std::memory_order_relaxed);
+                        v[c] = c == c_peak_capacity ? (std::max)(v[c], x) : v[c] + x;
+                    }
+                }
+                if (v[c_allocations] == 0 && v[c_releases] == 0) continue;
+                result.push_back({ std::string(r.types[t].name), r.types[t].size,
+                    v[c_allocations], v[c_reallocations], v[c_enlarges], v[c_shrinks], v[c_releases],
+                    v[c_bytes_allocated], v[c_bytes_copied], v[c_peak_capacity] });
+            }
+        }
+        std::sort(result.begin(), result.end(),
+            [](const AllocTypeStats& a, const AllocTypeStats& b) { return a.bytes_copied > b.bytes_copied; });
+        return result;
+    }
+
+    /**
+     * @brief Clears all counters. Counters of threads that are allocating concurrently
+     *        may keep a few events from before the reset.
+     */
+    inline void alloc_reset() {
+        if constexpr (alloc_stats::enabled) {
+            using namespace alloc_stats::detail;
+            auto& r = Registry::instance();
+            std::lock_guard lock(r.mutex);
+            for (auto& row : r.retired) std::fill(std::begin(row), std::end(row), 0);
+            for (auto* block : r.threads) {
+                for (auto& s : block->slots) {
+                    for (auto& v : s.value) v.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Formats alloc_report() as a table.
+     */
+    inline std::string alloc_report_string() {
+        if constexpr (!alloc_stats::enabled) {
+            return "allocation statistics disabled (define MZ_ALLOC_STATS=1)\n";
+        }
+        else {
+            std::string out = std::format("{:<24} {:>10} {:>8} {:>8} {:>7} {:>14} {:>14} {:>12}\n",
+                "type", "allocs", "reallocs", "enlarges", "shrinks", "bytes alloc", "bytes copied", "peak cap");
+            for (auto& s : alloc_report()) {
+                out += std::format("{:<24} {:>10} {:>8} {:>8} {:>7} {:>14} {:>14} {:>12}\n",
+                    s.type, s.allocations, s.reallocations, s.enlarges, s.shrinks,
+                    s.bytes_allocated, s.bytes_copied, s.peak_capacity_bytes);
+            }
+            return out;
+        }
+    }
+
+    /**
+     * @brief Prints alloc_report_string() to stdout.
+     */
+    inline void print_alloc_report() {
+        std::fputs(alloc_report_string().c_str(), stdout);
+    }
+
+} // namespace mz
+
+#endif // MZ_ALLOC_UTILS_HEADER_FILE
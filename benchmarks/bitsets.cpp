@@ -0,0 +1,255 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file bitsets.cpp
+ * @brief BitsT and BitLinesT against std::bitset and plain shifts on raw integers.
+ *
+ * For every width alias (B8-B64, Lines8-Lines64) and array sizes from 10^3 up to
+ * 10^max_log10 elements (default 10^7), each operation is run over the whole array in
+ * three implementations: "mz" (BitsT/BitLinesT), "raw" (the same operation written with
+ * shifts and masks on the underlying unsigned type, or <bit> for counting and scanning)
+ * and "std::bitset". Names read "group/op/width/implementation/size". Bit indices come
+ * from a random byte array shared by all three, so the comparison isolates how each
+ * implementation sets, tests and flips a bit: BitsT goes through the _bittest* family.
+ *
+ * Memory is about 3 arrays of the element width plus one index byte per element (25 bytes
+ * per element for 64 bits), so 10^8 needs about 2.5 GB.
+ *
+ * Build (from the repository root; zbitset.h needs the MSVC bit intrinsics):
+ *   cl /std:c++20 /O2 /EHsc /I. benchmarks\bitsets.cpp
+ *
+ * Usage (plus the options of mz::Bench, see zbench.h):
+ *   ./bitsets [max_log10_size] [--filter=/B64/] [--json=out.json]
+ */
+
+#include <bit>
+#include <bitset>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "../zbitset.h"
+#include "../zbench.h"
+
+namespace {
+
+    std::vector<int> sizes;
+
+    template <typename T>
+    constexpr int width = static_cast<int>(sizeof(T) * 8);
+
+    template <typename T>
+    std::string name_of(std::string_view group, std::string_view op, std::string_view impl, int n) {
+        return std::format("{}/{}/{}{}/{}/{}", group, op, group == "lines" ? "Lines" : "B", width<T>, impl, n);
+    }
+
+    /**
+     * @brief One array per implementation holding the same random bits, plus bit indices.
+     */
+    template <typename T>
+    struct BitsData {
+        std::vector<uint8_t> index;
+        std::vector<T> raw;
+        std::vector<BitsT<T>> mz;
+        std::vector<std::bitset<width<T>>> bs;
+
+        explicit BitsData(int n, uint64_t seed) :
+            index(static_cast<size_t>(n)), raw(static_cast<size_t>(n)), mz(static_cast<size_t>(n)), bs(static_cast<size_t>(n)) {
+            std::mt19937_64 rng(seed);
+            for (size_t i = 0; i < raw.size(); i++) {
+                index[i] = static_cast<uint8_t>(rng() % width<T>);
+                raw[i] = static_cast<T>(rng() & rng());     // about a quarter of the bits set
+                mz[i] = BitsT<T>(raw[i]);
+                bs[i] = std::bitset<width<T>>(static_cast<unsigned long long>(raw[i]));
+            }
+        }
+    };
+
+    template <typename T>
+    constexpr T bit(int k) noexcept { return static_cast<T>(T{ 1 } << k); }
+
+    // Runs the three implementations of one operation; each body takes the element index
+    template <typename T, typename Raw, typename Mz, typename Bs>
+    void compare(mz::Bench& bench, std::string_view group, std::string_view op, int n, Raw&& raw, Mz&& mzop, Bs&& bsop) {
+        mz::BenchWork const work{ .items = static_cast<double>(n) };
+        bench.run(name_of<T>(group, op, "raw", n), [&] {
+            uint64_t acc{ 0 };
+            for (size_t i = 0; i < static_cast<size_t>(n); i++) acc += raw(i);
+            mz::do_not_optimize(acc);
+        }, work);
+        bench.run(name_of<T>(group, op, "mz", n), [&] {
+            uint64_t acc{ 0 };
+            for (size_t i = 0; i < static_cast<size_t>(n); i++) acc += mzop(i);
+            mz::do_not_optimize(acc);
+        }, work);
+        bench.run(name_of<T>(group, op, "std::bitset", n), [&] {
+            uint64_t acc{ 0 };
+            for (size_t i = 0; i < static_cast<size_t>(n); i++) acc += bsop(i);
+            mz::do_not_optimize(acc);
+        }, work);
+    }
+
+    // --- BitsT ---
+
+    template <typename T>
+    void bits(mz::Bench& bench) {
+        using U = std::make_unsigned_t<T>;
+        for (int n : sizes) {
+            BitsData<T> a(n, 1), b(n, 2);
+            auto& k = a.index;
+
+            compare<T>(bench, "bits", "set", n,
+                [&](size_t i) { a.raw[i] |= bit<T>(k[i]); return uint64_t{ 0 }; },
+                [&](size_t i) { a.mz[i].set(k[i]); return uint64_t{ 0 }; },
+                [&](size_t i) { a.bs[i].set(k[i]); return uint64_t{ 0 }; });
+            compare<T>(bench, "bits", "test_and_set", n,
+                [&](size_t i) { uint64_t const r = (a.raw[i] >> k[i]) & 1; a.raw[i] |= bit<T>(k[i]); return r; },
+                [&](size_t i) { return static_cast<uint64_t>(a.mz[i].test_and_set(k[i])); },
+                [&](size_t i) { uint64_t const r = a.bs[i].test(k[i]); a.bs[i].set(k[i]); return r; });
+            compare<T>(bench, "bits", "get", n,
+                [&](size_t i) { return static_cast<uint64_t>((a.raw[i] >> k[i]) & 1); },
+                [&](size_t i) { return static_cast<uint64_t>(a.mz[i].get(k[i])); },
+                [&](size_t i) { return static_cast<uint64_t>(a.bs[i][k[i]]); });
+            compare<T>(bench, "bits", "comp", n,
+                [&](size_t i) { uint64_t const r = (a.raw[i] >> k[i]) & 1; a.raw[i] ^= bit<T>(k[i]); return r; },
+                [&](size_t i) { return static_cast<uint64_t>(a.mz[i].comp(k[i])); },
+                [&](size_t i) { uint64_t const r = a.bs[i].test(k[i]); a.bs[i].flip(k[i]); return r; });
+
+            compare<T>(bench, "bits", "pop_count", n,
+                [&](size_t i) { return static_cast<uint64_t>(std::popcount(static_cast<U>(a.raw[i]))); },
+                [&](size_t i) { return static_cast<uint64_t>(a.mz[i].pop_count()); },
+                [&](size_t i) { return static_cast<uint64_t>(a.bs[i].count()); });
+            // lz_count counts over at least 32 bits, so the raw and bitset versions do too
+            compare<T>(bench, "bits", "lz_count", n,
+                [&](size_t i) { return static_cast<uint64_t>(std::countl_zero(static_cast<std::conditional_t<(sizeof(T) <= 4), uint32_t, uint64_t>>(a.raw[i]))); },
+                [&](size_t i) { return static_cast<uint64_t>(a.mz[i].lz_count()); },
+                [&](size_t i) {
+                    auto const& s = a.bs[i];
+                    int const top = sizeof(T) <= 4 ? 32 : 64;
+                    int z{ top - width<T> };
+                    for (int j = width<T> - 1; j >= 0 && !s[static_cast<size_t>(j)]; j--) z++;
+                    return static_cast<uint64_t>(z);
+                });
+            // std::bitset has no scan; its column loops over the bits
+            compare<T>(bench, "bits", "bit_scan_reverse", n,
+                [&](size_t i) { return static_cast<uint64_t>(std::bit_width(static_cast<U>(a.raw[i])) - 1); },
+                [&](size_t i) { return static_cast<uint64_t>(a.mz[i].bit_scan_reverse()); },
+                [&](size_t i) {
+                    int j = width<T> - 1;
+                    while (j >= 0 && !a.bs[i][static_cast<size_t>(j)]) j--;
+                    return static_cast<uint64_t>(j);
+                });
+            compare<T>(bench, "bits", "leastSignificantOne", n,
+                [&](size_t i) { return a.raw[i] ? static_cast<uint64_t>(std::countr_zero(static_cast<U>(a.raw[i]))) : ~uint64_t{ 0 }; },
+                [&](size_t i) { return static_cast<uint64_t>(a.mz[i].leastSignificantOne()); },
+                [&](size_t i) {
+                    int j{ 0 };
+                    while (j < width<T> && !a.bs[i][static_cast<size_t>(j)]) j++;
+                    return j < width<T> ? static_cast<uint64_t>(j) : ~uint64_t{ 0 };
+                });
+
+            compare<T>(bench, "bits", "subset<=", n,
+                [&](size_t i) { return static_cast<uint64_t>((a.raw[i] & ~b.raw[i]) == 0); },
+                [&](size_t i) { return static_cast<uint64_t>(a.mz[i] <= b.mz[i]); },
+                [&](size_t i) { return static_cast<uint64_t>((a.bs[i] & ~b.bs[i]).none()); });
+            compare<T>(bench, "bits", "subset<", n,
+                [&](size_t i) { return static_cast<uint64_t>((a.raw[i] & ~b.raw[i]) == 0 && a.raw[i] != b.raw[i]); },
+                [&](size_t i) { return static_cast<uint64_t>(a.mz[i] < b.mz[i]); },
+                [&](size_t i) { return static_cast<uint64_t>((a.bs[i] & ~b.bs[i]).none() && a.bs[i] != b.bs[i]); });
+        }
+    }
+
+    // --- BitLinesT ---
+
+    template <typename T>
+    void lines(mz::Bench& bench) {
+        using U = std::make_unsigned_t<T>;
+        using Bs = std::bitset<width<T>>;
+        for (int n : sizes) {
+            BitsData<T> pos(n, 3), neg(n, 4);
+            std::vector<BitLinesT<T>> mzl(static_cast<size_t>(n));
+            for (size_t i = 0; i < mzl.size(); i++) mzl[i] = BitLinesT<T>(pos.mz[i], neg.mz[i]);
+            pos.mz = {};
+            neg.mz = {};
+            auto& k = pos.index;
+
+            // whole-word views, reduced with a population count
+            auto view = [&](std::string_view op, auto raw, auto mzv, auto bsv) {
+                compare<T>(bench, "lines", op, n,
+                    [&](size_t i) { return static_cast<uint64_t>(std::popcount(static_cast<U>(raw(pos.raw[i], neg.raw[i])))); },
+                    [&](size_t i) { return static_cast<uint64_t>(mzv(mzl[i]).pop_count()); },
+                    [&](size_t i) { return static_cast<uint64_t>(bsv(pos.bs[i], neg.bs[i]).count()); });
+            };
+            view("onlypos", [](T p, T q) { return static_cast<T>(p & ~q); }, [](const BitLinesT<T>& l) { return l.onlypos(); }, [](const Bs& p, const Bs& q) { return p & ~q; });
+            view("onlyneg", [](T p, T q) { return static_cast<T>(q & ~p); }, [](const BitLinesT<T>& l) { return l.onlyneg(); }, [](const Bs& p, const Bs& q) { return q & ~p; });
+            view("both", [](T p, T q) { return static_cast<T>(p & q); }, [](const BitLinesT<T>& l) { return l.both(); }, [](const Bs& p, const Bs& q) { return p & q; });
+            view("either", [](T p, T q) { return static_cast<T>(p | q); }, [](const BitLinesT<T>& l) { return l.either(); }, [](const Bs& p, const Bs& q) { return p | q; });
+            view("neither", [](T p, T q) { return static_cast<T>(~(p | q)); }, [](const BitLinesT<T>& l) { return l.neither(); }, [](const Bs& p, const Bs& q) { return ~(p | q); });
+            view("diff", [](T p, T q) { return static_cast<T>(p ^ q); }, [](const BitLinesT<T>& l) { return l.diff(); }, [](const Bs& p, const Bs& q) { return p ^ q; });
+            view("same", [](T p, T q) { return static_cast<T>(~(p ^ q)); }, [](const BitLinesT<T>& l) { return l.same(); }, [](const Bs& p, const Bs& q) { return ~(p ^ q); });
+            view("nonpos", [](T p, T) { return static_cast<T>(~p); }, [](const BitLinesT<T>& l) { return l.nonpos(); }, [](const Bs& p, const Bs&) { return ~p; });
+            view("nonneg", [](T, T q) { return static_cast<T>(~q); }, [](const BitLinesT<T>& l) { return l.nonneg(); }, [](const Bs&, const Bs& q) { return ~q; });
+
+            // single-bit views and updates
+            compare<T>(bench, "lines", "onlypos(i)", n,
+                [&](size_t i) { return static_cast<uint64_t>(((pos.raw[i] & ~neg.raw[i]) >> k[i]) & 1); },
+                [&](size_t i) { return static_cast<uint64_t>(mzl[i].onlypos(k[i])); },
+                [&](size_t i) { return static_cast<uint64_t>(pos.bs[i][k[i]] && !neg.bs[i][k[i]]); });
+            compare<T>(bench, "lines", "both(i)", n,
+                [&](size_t i) { return static_cast<uint64_t>(((pos.raw[i] & neg.raw[i]) >> k[i]) & 1); },
+                [&](size_t i) { return static_cast<uint64_t>(mzl[i].both(k[i])); },
+                [&](size_t i) { return static_cast<uint64_t>(pos.bs[i][k[i]] && neg.bs[i][k[i]]); });
+            compare<T>(bench, "lines", "neither(i)", n,
+                [&](size_t i) { return static_cast<uint64_t>((~(pos.raw[i] | neg.raw[i]) >> k[i]) & 1); },
+                [&](size_t i) { return static_cast<uint64_t>(mzl[i].neither(k[i])); },
+                [&](size_t i) { return static_cast<uint64_t>(!pos.bs[i][k[i]] && !neg.bs[i][k[i]]); });
+            compare<T>(bench, "lines", "set_onlypos(i)", n,
+                [&](size_t i) { pos.raw[i] |= bit<T>(k[i]); neg.raw[i] &= static_cast<T>(~bit<T>(k[i])); return uint64_t{ 0 }; },
+                [&](size_t i) { mzl[i].set_onlypos(k[i]); return uint64_t{ 0 }; },
+                [&](size_t i) { pos.bs[i].set(k[i]); neg.bs[i].reset(k[i]); return uint64_t{ 0 }; });
+            compare<T>(bench, "lines", "pop_count", n,
+                [&](size_t i) { return static_cast<uint64_t>(std::popcount(static_cast<U>(pos.raw[i])) + std::popcount(static_cast<U>(neg.raw[i]))); },
+                [&](size_t i) { return static_cast<uint64_t>(mzl[i].pop_count()); },
+                [&](size_t i) { return static_cast<uint64_t>(pos.bs[i].count() + neg.bs[i].count()); });
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    mz::Bench bench(argc, argv, { .warmup_seconds = 0.01, .min_time = 0.005, .repetitions = 9 });
+    int max_log10{ 7 };
+    for (int i = 1; i < argc; i++) if (argv[i][0] != '-') max_log10 = std::clamp(std::atoi(argv[i]), 3, 8);
+    for (int e = 3, n = 1000; e <= max_log10; e++, n *= 10) sizes.push_back(n);
+
+    bits<uint8_t>(bench);
+    bits<uint16_t>(bench);
+    bits<uint32_t>(bench);
+    bits<uint64_t>(bench);
+    lines<uint8_t>(bench);
+    lines<uint16_t>(bench);
+    lines<uint32_t>(bench);
+    lines<uint64_t>(bench);
+    return bench.finish();
+}
@@ -0,0 +1,337 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file containers.cpp
+ * @brief Vector, Span and Slice against std::vector, std::span and std::valarray.
+ *
+ * Covers growth (push_back/enlarge, reserve, append), copy and move, the index and mask
+ * selectors, every elementwise operator on contiguous and strided (step 2) sequences, and
+ * sort/unique/find. Each case is swept over sizes from L1-resident (4K elements) to
+ * DRAM-resident (16M elements by default); names read "group/op/implementation/size".
+ *
+ * Build (from the repository root):
+ *   c++ -std=c++20 -O2 -I. benchmarks/containers.cpp -o containers
+ *
+ * Usage (plus the options of mz::Bench, see zbench.h):
+ *   ./containers [max_log2_size] [--filter=elementwise/add] [--json=out.json]
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <span>
+#include <valarray>
+#include <vector>
+#include "../Vector.h"
+#include "../Span.h"
+#include "../Slice.h"
+#include "../zbench.h"
+
+namespace {
+
+    std::vector<int> sizes;
+
+    std::string name_of(std::string_view group, std::string_view op, std::string_view impl, int n) {
+        return std::format("{}/{}/{}/{}", group, op, impl, n);
+    }
+
+    template <typename T>
+    std::vector<T> random_values(int n, uint64_t seed = 1) {
+        std::mt19937_64 rng(seed);
+        std::vector<T> v(static_cast<size_t>(n));
+        for (T& x : v) x = static_cast<T>(rng() % 1000 + 1);
+        return v;
+    }
+
+    template <typename T>
+    mz::Vector<T> to_vector(const std::vector<T>& s) {
+        mz::Vector<T> v;
+        v.resize(static_cast<size_type>(s.size()), false);
+        std::copy(s.begin(), s.end(), v.data());
+        return v;
+    }
+
+    // --- Growth, copy and move ---
+
+    void growth(mz::Bench& bench) {
+        for (int n : sizes) {
+            mz::BenchWork const work{ .bytes = 4.0 * n, .items = static_cast<double>(n) };
+            bench.run(name_of("growth", "push_back", "mz::Vector", n), [n] {
+                mz::Vector<int> v;
+                for (int i = 0; i < n; i++) v.push_back(i);
+                mz::do_not_optimize(v.data());
+            }, work);
+            bench.run(name_of("growth", "push_back", "std::vector", n), [n] {
+                std::vector<int> v;
+                for (int i = 0; i < n; i++) v.push_back(i);
+                mz::do_not_optimize(v.data());
+            }, work);
+            bench.run(name_of("growth", "reserve+push_back", "mz::Vector", n), [n] {
+                mz::Vector<int> v;
+                v.reserve(n, false);
+                for (int i = 0; i < n; i++) v.push_back(i);
+                mz::do_not_optimize(v.data());
+            }, work);
+            bench.run(name_of("growth", "reserve+push_back", "std::vector", n), [n] {
+                std::vector<int> v;
+                v.reserve(static_cast<size_t>(n));
+                for (int i = 0; i < n; i++) v.push_back(i);
+                mz::do_not_optimize(v.data());
+            }, work);
+
+            std::vector<int> const source = random_values<int>(n);
+            mz::Vector<int> const mz_source = to_vector(source);
+            bench.run(name_of("growth", "append", "mz::Vector", n), [&] {
+                mz::Vector<int> v;
+                v.append(mz::Span<const int>(mz_source.data(), mz_source.size()));
+                mz::do_not_optimize(v.data());
+            }, work);
+            bench.run(name_of("growth", "append", "std::vector", n), [&] {
+                std::vector<int> v;
+                v.insert(v.end(), source.begin(), source.end());
+                mz::do_not_optimize(v.data());
+            }, work);
+
+            bench.run(name_of("copy", "copy-construct", "mz::Vector", n), [&] {
+                mz::Vector<int> v(mz_source);
+                mz::do_not_optimize(v.data());
+            }, work);
+            bench.run(name_of("copy", "copy-construct", "std::vector", n), [&] {
+                std::vector<int> v(source);
+                mz::do_not_optimize(v.data());
+            }, work);
+            bench.run(name_of("copy", "move-construct", "mz::Vector", n), [&, v = mz::Vector<int>(mz_source)]() mutable {
+                mz::Vector<int> w(std::move(v));
+                v = std::move(w);
+                mz::do_not_optimize(v.data());
+            });
+            bench.run(name_of("copy", "move-construct", "std::vector", n), [&, v = std::vector<int>(source)]() mutable {
+                std::vector<int> w(std::move(v));
+                v = std::move(w);
+                mz::do_not_optimize(v.data());
+            });
+        }
+    }
+
+    // --- Selectors ---
+
+    void selectors(mz::Bench& bench) {
+        for (int n : sizes) {
+            mz::BenchWork const work{ .items = static_cast<double>(n) };
+            std::vector<double> const source = random_values<double>(n);
+            mz::Vector<double> const mz_source = to_vector(source);
+
+            std::vector<int> index(static_cast<size_t>(n));
+            std::mt19937 rng(7);
+            for (int& i : index) i = static_cast<int>(rng() % static_cast<unsigned>(n));
+            mz::Vector<int> const mz_index = to_vector(index);
+
+            std::vector<uint8_t> mask(static_cast<size_t>(n));
+            for (int i = 0; i < n; i++) mask[static_cast<size_t>(i)] = (source[static_cast<size_t>(i)] > 500) ? 1 : 0;
+            mz::Vector<uint8_t> const mz_mask = to_vector(mask);
+
+            bench.run(name_of("select", "gather", "mz::Vector[index]", n), [&] {
+                mz::Vector<double> r = mz_source[mz_index];
+                mz::do_not_optimize(r.data());
+            }, work);
+            bench.run(name_of("select", "gather", "std::vector loop", n), [&] {
+                std::vector<double> r(index.size());
+                for (size_t i = 0; i < index.size(); i++) r[i] = source[static_cast<size_t>(index[i])];
+                mz::do_not_optimize(r.data());
+            }, work);
+            bench.run(name_of("select", "mask", "mz::Vector[mask]", n), [&] {
+                mz::Vector<double> r = mz_source[mz_mask];
+                mz::do_not_optimize(r.data());
+            }, work);
+            bench.run(name_of("select", "mask", "std::vector loop", n), [&] {
+                std::vector<double> r;
+                r.reserve(static_cast<size_t>(std::count(mask.begin(), mask.end(), 1)));
+                for (size_t i = 0; i < mask.size(); i++) if (mask[i]) r.push_back(source[i]);
+                mz::do_not_optimize(r.data());
+            }, work);
+        }
+    }
+
+    // --- Elementwise operators ---
+
+    // a op= b on contiguous data, for each implementation
+    template <typename T, typename Op>
+    void elementwise_contiguous(mz::Bench& bench, std::string_view op, Op apply, int n) {
+        mz::BenchWork const work{ .bytes = 3.0 * sizeof(T) * n, .items = static_cast<double>(n) };
+        std::vector<T> const lhs = random_values<T>(n, 1), rhs = random_values<T>(n, 2);
+
+        bench.run(name_of("elementwise", op, "std::vector loop", n), [&, a = lhs]() mutable {
+            for (size_t i = 0; i < a.size(); i++) apply(a[i], rhs[i]);
+            mz::clobber_memory();
+        }, work);
+        bench.run(name_of("elementwise", op, "std::span loop", n), [&, a = lhs]() mutable {
+            std::span<T> s(a);
+            std::span<const T> t(rhs);
+            for (size_t i = 0; i < s.size(); i++) apply(s[i], t[i]);
+            mz::clobber_memory();
+        }, work);
+        bench.run(name_of("elementwise", op, "std::valarray", n), [&, a = std::valarray<T>(lhs.data(), lhs.size()), b = std::valarray<T>(rhs.data(), rhs.size())]() mutable {
+            apply(a, b);
+            mz::clobber_memory();
+        }, work);
+        bench.run(name_of("elementwise", op, "mz::Vector op Vector", n), [&, a = to_vector(lhs), b = to_vector(rhs)]() mutable {
+            apply(a, b);
+            mz::clobber_memory();
+        }, work);
+        bench.run(name_of("elementwise", op, "mz::Vector op Span", n), [&, a = to_vector(lhs), b = to_vector(rhs)]() mutable {
+            apply(a, mz::Span<T>(b.data(), b.size()));
+            mz::clobber_memory();
+        }, work);
+        bench.run(name_of("elementwise", op, "mz::Span op Span", n), [&, a = to_vector(lhs), b = to_vector(rhs)]() mutable {
+            mz::Span<T> s(a.data(), a.size());
+            apply(s, mz::Span<T>(b.data(), b.size()));
+            mz::clobber_memory();
+        }, work);
+        bench.run(name_of("elementwise", op, "mz::Span op scalar", n), [&, a = to_vector(lhs)]() mutable {
+            mz::Span<T> s(a.data(), a.size());
+            apply(s, T(3));
+            mz::clobber_memory();
+        }, work);
+        bench.run(name_of("elementwise", op, "std::span scalar loop", n), [&, a = lhs]() mutable {
+            std::span<T> s(a);
+            for (size_t i = 0; i < s.size(); i++) apply(s[i], T(3));
+            mz::clobber_memory();
+        }, work);
+    }
+
+    // a op= b on every second element of both sides
+    template <typename T, typename Op>
+    void elementwise_strided(mz::Bench& bench, std::string_view op, Op apply, int n) {
+        int const half = n / 2;
+        mz::BenchWork const work{ .bytes = 3.0 * sizeof(T) * half, .items = static_cast<double>(half) };
+        std::vector<T> const lhs = random_values<T>(n, 1), rhs = random_values<T>(n, 2);
+        std::string const strided = std::format("{}/step2", op);
+
+        bench.run(name_of("elementwise", strided, "std::vector loop", n), [&, a = lhs]() mutable {
+            for (size_t i = 0; i < a.size(); i += 2) apply(a[i], rhs[i]);
+            mz::clobber_memory();
+        }, work);
+        bench.run(name_of("elementwise", strided, "std::valarray slice", n), [&, a = std::valarray<T>(lhs.data(), lhs.size()), b = std::valarray<T>(rhs.data(), static_cast<size_t>(half))]() mutable {
+            std::slice_array<T> s = a[std::slice(0, static_cast<size_t>(half), 2)];
+            apply(s, b);           // valarray has no slice op= slice; the right side is contiguous
+            mz::clobber_memory();
+        }, work);
+        bench.run(name_of("elementwise", strided, "mz::Slice op Slice", n), [&, a = to_vector(lhs), b = to_vector(rhs)]() mutable {
+            mz::Slice<T> s(a.data(), half, 2);
+            apply(s, mz::Slice<T>(b.data(), half, 2));
+            mz::clobber_memory();
+        }, work);
+        bench.run(name_of("elementwise", strided, "mz::Slice op scalar", n), [&, a = to_vector(lhs)]() mutable {
+            mz::Slice<T> s(a.data(), half, 2);
+            apply(s, T(3));
+            mz::clobber_memory();
+        }, work);
+    }
+
+    template <typename T, typename Op>
+    void elementwise_op(mz::Bench& bench, std::string_view op, Op apply) {
+        for (int n : sizes) {
+            elementwise_contiguous<T>(bench, op, apply, n);
+            elementwise_strided<T>(bench, op, apply, n);
+        }
+    }
+
+    void elementwise(mz::Bench& bench) {
+        elementwise_op<double>(bench, "add", [](auto&& a, auto const& b) { a += b; });
+        elementwise_op<double>(bench, "sub", [](auto&& a, auto const& b) { a -= b; });
+        elementwise_op<double>(bench, "mul", [](auto&& a, auto const& b) { a *= b; });
+        elementwise_op<double>(bench, "div", [](auto&& a, auto const& b) { a /= b; });
+        elementwise_op<uint32_t>(bench, "and", [](auto&& a, auto const& b) { a &= b; });
+        elementwise_op<uint32_t>(bench, "or", [](auto&& a, auto const& b) { a |= b; });
+        elementwise_op<uint32_t>(bench, "xor", [](auto&& a, auto const& b) { a ^= b; });
+    }
+
+    // --- Sort, unique, find ---
+
+    void algorithms(mz::Bench& bench) {
+        for (int n : sizes) {
+            mz::BenchWork const work{ .items = static_cast<double>(n) };
+            std::vector<int> const source = random_values<int>(n);
+            mz::Vector<int> const mz_source = to_vector(source);
+
+            // the copy is part of both measurements, so they stay comparable
+            bench.run(name_of("algorithm", "sort", "mz::Vector", n), [&] {
+                mz::Vector<int> v(mz_source);
+                v.sort();
+                mz::do_not_optimize(v.data());
+            }, work);
+            bench.run(name_of("algorithm", "sort", "std::vector", n), [&] {
+                std::vector<int> v(source);
+                std::sort(v.begin(), v.end());
+                mz::do_not_optimize(v.data());
+            }, work);
+
+            std::vector<int> sorted = source;
+            std::sort(sorted.begin(), sorted.end());
+            mz::Vector<int> const mz_sorted = to_vector(sorted);
+            bench.run(name_of("algorithm", "unique", "mz::Vector", n), [&] {
+                mz::Vector<int> v(mz_sorted);
+                mz::do_not_optimize(v.unique());
+            }, work);
+            bench.run(name_of("algorithm", "unique", "std::vector", n), [&] {
+                std::vector<int> v(sorted);
+                v.erase(std::unique(v.begin(), v.end()), v.end());
+                mz::do_not_optimize(v.data());
+            }, work);
+
+            // 1024 lookups of present and absent keys per iteration
+            std::vector<int> keys = random_values<int>(1024, 3);
+            mz::BenchWork const lookups{ .items = 1024 };
+            bench.run(name_of("algorithm", "find x1024", "mz::Vector", n), [&] {
+                int hits{ 0 };
+                for (int k : keys) hits += mz_sorted.find(k) >= 0;
+                mz::do_not_optimize(hits);
+            }, lookups);
+            bench.run(name_of("algorithm", "find x1024", "std::lower_bound", n), [&] {
+                int hits{ 0 };
+                for (int k : keys) {
+                    auto it = std::lower_bound(sorted.begin(), sorted.end(), k);
+                    hits += it != sorted.end() && *it == k;
+                }
+                mz::do_not_optimize(hits);
+            }, lookups);
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    mz::Bench bench(argc, argv, { .warmup_seconds = 0.01, .min_time = 0.005, .repetitions = 9 });
+    int max_log2{ 24 };
+    for (int i = 1; i < argc; i++) if (argv[i][0] != '-') max_log2 = std::clamp(std::atoi(argv[i]), 12, 28);
+    for (int log2 = 12; log2 <= max_log2; log2 += 4) sizes.push_back(1 << log2);
+
+    growth(bench);
+    selectors(bench);
+    elementwise(bench);
+    algorithms(bench);
+    return bench.finish();
+}
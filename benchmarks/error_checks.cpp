@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file error_checks.cpp
+ * @brief Measures the cost of the container precondition checks under the MZ_CHECKS policy.
+ *
+ * The policy is fixed at compile time, so build the benchmark once per policy and compare:
+ *   c++ -std=c++20 -O2 -I. benchmarks/error_checks.cpp -o checks_on
+ *   c++ -std=c++20 -O2 -I. -DMZ_CHECKS=MZ_CHECKS_UNCHECKED benchmarks/error_checks.cpp -o checks_off
+ *
+ * Usage (options of mz::Bench, see zbench.h):
+ *   ./checks_off --json=unchecked.json
+ *   ./checks_on --baseline=unchecked.json
+ */
+
+#include "../Vector.h"
+#include "../Span.h"
+#include "../zbench.h"
+
+int main(int argc, char** argv) {
+    mz::Bench bench(argc, argv);
+
+    mz::print("MZ_CHECKS = {} ({})\n", MZ_CHECKS, MZ_CHECKS_ENABLED ? "checked" : "unchecked");
+
+    mz::Vector<int> a, b;
+    a.resize_and_initialize(16, 1);
+    b.resize_and_initialize(16, 2);
+    mz::Span<int> sa(a.data(), a.size());
+    mz::Span<int> sb(b.data(), b.size());
+
+    bench.run("Span += Span (16 ints)", [&] { sa += sb; mz::clobber_memory(); });
+    bench.run("Span *= Span (16 ints)", [&] { sa *= sb; sa -= sb; mz::clobber_memory(); });
+    bench.run("Span = Span (16 ints)", [&] { sa = sb; mz::clobber_memory(); });
+
+    bench.run("Vector back/front", [&] { mz::do_not_optimize(a.back() + a.front()); });
+    bench.run("Vector push_back/pop_back", [&] { a.push_back(3); mz::do_not_optimize(a.pop_back()); });
+    bench.run("Span pop_front x16", [&] {
+        mz::Span<int> s(b.data(), b.size());
+        for (int i = 0; i < 16; i++) mz::do_not_optimize(s.pop_front());
+    });
+
+    return bench.finish();
+}
@@ -0,0 +1,96 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file stream_throughput.cpp
+ * @brief Compares Vector save/load throughput of FileStream against the mapped and
+ *        checksummed streams.
+ *
+ * Build (from the repository root):
+ *   c++ -std=c++20 -O2 -I. benchmarks/stream_throughput.cpp -o stream_throughput
+ *
+ * Usage (plus the options of mz::Bench, see zbench.h; each case runs once to calibrate
+ * and then 3 timed repetitions unless --repetitions is given):
+ *   ./stream_throughput [element_count] [file_name] [--json=out.json] [--baseline=old.json]
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../Vector.h"
+#include "../zmmap.h"
+#include "../zchecksum.h"
+#include "../zbench.h"
+
+int main(int argc, char** argv) {
+    // Whole-file cases are too slow for the default warmup and 15 samples
+    mz::Bench bench(argc, argv, { .warmup_seconds = 0, .min_time = 0, .repetitions = 3 });
+    std::vector<const char*> args;
+    for (int i = 1; i < argc; i++) if (argv[i][0] != '-' || argv[i][1] != '-') args.push_back(argv[i]);
+
+    size_type const count = args.size() > 0 ? std::atoi(args[0]) : (1 << 27);
+    const char* path = args.size() > 1 ? args[1] : "mz_stream_throughput.bin";
+    size_t const bytes = sizeof(double) * static_cast<size_t>(count);
+
+    auto measure = [&](const char* name, size_t n, auto&& body) {
+        bench.run(name, body, { .bytes = static_cast<double>(n) });
+    };
+
+    mz::Vector<double> values;
+    values.resize(count, false);
+    for (size_type i = 0; i < count; i++) values[i] = 0.5 * i;
+
+    mz::print("Vector<double> of {} elements ({} MB)\n", count, bytes >> 20);
+
+    std::remove(path);
+    measure("FileStream save", bytes, [&] { mz::FileStream fs(path); values.save(fs); fs.close(); });
+    measure("FileStream load (fstream)", bytes, [&] {
+        mz::FileStream fs(path);
+        fs.set_read_options({ .parallel_threshold = SIZE_MAX });
+        mz::Vector<double> v;
+        v.load(fs);
+    });
+    measure("FileStream load (pread)", bytes, [&] { mz::FileStream fs(path); mz::Vector<double> v; v.load(fs); });
+    measure("FileStream load (O_DIRECT)", bytes, [&] {
+        mz::FileStream fs(path);
+        fs.set_read_options({ .direct = true });
+        mz::Vector<double> v;
+        v.load(fs);
+    });
+
+    std::remove(path);
+    measure("MmapWriteStream save", bytes, [&] { mz::MmapWriteStream ws(path, mz::MmapSync::none); values.save(ws); ws.close(); });
+    measure("MmapWriteStream save+msync", bytes, [&] { mz::MmapWriteStream ws(path, mz::MmapSync::on_close, bytes + 64); values.save(ws); ws.close(); });
+    measure("MmapStream load", bytes, [&] { mz::MmapStream ms(path); ms.advise(mz::MmapAdvice::sequential); mz::Vector<double> v; v.load(ms); });
+
+    std::remove(path);
+    measure("ChecksumStream crc32c save", bytes, [&] { mz::FileStream fs(path); mz::ChecksumStream cs(fs); values.save(cs); cs.close(); });
+    measure("ChecksumStream crc32c load", bytes, [&] { mz::FileStream fs(path); mz::ChecksumStream cs(fs); mz::Vector<double> v; v.load(cs); });
+    measure("verify_file crc32c", bytes, [&] { if (!mz::verify_file(path).ok) mz::print("verify_file failed\n"); });
+    std::remove(path);
+    measure("ChecksumStream xxhash64 save", bytes, [&] { mz::FileStream fs(path); mz::ChecksumStream cs(fs, mz::ChecksumKind::xxhash64); values.save(cs); cs.close(); });
+
+    std::remove(path);
+    return bench.finish();
+}
@@ -25,6 +25,7 @@
 #define MZ_CONCEPT_UTILS_HEADER_FILE
 #pragma once
 #include <concepts>
+#include <format>
 #include <type_traits>
 #include <string_view>
 #include <string>
@@ -49,6 +50,25 @@ namespace mz {
 		{ obj.string(fmt) } -> std::same_as<std::string>;
 	};
 
+	/**
+	 * @brief Concept for types that can format themselves into an output iterator.
+	 *
+	 * Satisfied if T provides a member template
+	 *   template <typename OutputIt> OutputIt T::format_to(OutputIt out, std::string_view fmt) const;
+	 * taking the same format string as string(fmt). Container formatters prefer it to
+	 * string(fmt), because nothing is allocated per element.
+	 */
+	template <typename T>
+	concept HasFormatTo = requires(std::remove_cvref_t<T> const& obj, std::format_context::iterator out, std::string_view fmt) {
+		{ obj.format_to(out, fmt) } -> std::same_as<std::format_context::iterator>;
+	};
+
+	/**
+	 * @brief Concept for types with a usable std::formatter specialization.
+	 */
+	template <typename T>
+	concept StdFormattable = std::semiregular<std::formatter<std::remove_cvref_t<T>, char>>;
+
 	/**
 	 * @brief Concept to check if a type is a standard arithmetic type.
 	 *
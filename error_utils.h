@@ -27,10 +27,50 @@
 #include <format>
 #include <stdexcept>
 #include <exception>
-#include <conio.h>
 #include <stdio.h>
 #include "string_utils.h"
 
+#if defined(_WIN32)
+#include <conio.h>
+#else
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Error check policy for the container preconditions (CHECK_DOMAIN_ERROR_IF): empty
+ * back/front/pop, size mismatches of elementwise operations and assignments.
+ *   MZ_CHECKS_CHECKED   always checked (default)
+ *   MZ_CHECKS_DEBUG     checked unless NDEBUG is defined
+ *   MZ_CHECKS_UNCHECKED never checked; a violated precondition is undefined behavior
+ * Select one with -DMZ_CHECKS=MZ_CHECKS_DEBUG (etc.), consistently across the program.
+ * Errors that depend on the environment (files, mappings, streams) are always checked.
+ *
+ * Every throwing macro keeps its hot path to one predicted-not-taken branch: the message
+ * formatting and the throw live in cold, never-inlined helpers.
+ */
+#define MZ_CHECKS_UNCHECKED 0
+#define MZ_CHECKS_DEBUG 1
+#define MZ_CHECKS_CHECKED 2
+
+#ifndef MZ_CHECKS
+#define MZ_CHECKS MZ_CHECKS_CHECKED
+#endif
+
+#if MZ_CHECKS == MZ_CHECKS_CHECKED || (MZ_CHECKS == MZ_CHECKS_DEBUG && !defined(NDEBUG))
+#define MZ_CHECKS_ENABLED 1
+#else
+#define MZ_CHECKS_ENABLED 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MZ_COLD_NOINLINE [[gnu::cold, gnu::noinline]]
+#elif defined(_MSC_VER)
+#define MZ_COLD_NOINLINE __declspec(noinline)
+#else
+#define MZ_COLD_NOINLINE
+#endif
+
 
 
 
@@ -43,7 +83,23 @@ namespace mz
 	 * @return The character read as an int.
 	 * Usage: int c = mz::getch();
 	 */
+#if defined(_WIN32)
 	inline int getch() noexcept { return _getch(); }
+#else
+	inline int getch() noexcept {
+		termios saved{};
+		if (tcgetattr(STDIN_FILENO, &saved) != 0) return getchar();
+		termios raw = saved;
+		raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+		raw.c_cc[VMIN] = 1;
+		raw.c_cc[VTIME] = 0;
+		tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+		unsigned char c{ 0 };
+		int const n = static_cast<int>(read(STDIN_FILENO, &c, 1));
+		tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+		return n == 1 ? c : EOF;
+	}
+#endif
 
 
 
@@ -52,19 +108,19 @@ namespace mz
      * @brief Prints a generic logic error message to stdout.
      * Usage: mz::logic_error_message();
      */
-    inline void logic_error_message() noexcept { print("LogicError!"); }
+    inline void logic_error_message() noexcept { print("LogicError!"); print_flush(); }
 
     /**
      * @brief Prints a generic domain error message to stdout.
      * Usage: mz::domain_error_message();
      */
-    inline void domain_error_message() noexcept { print("DomainError!"); }
+    inline void domain_error_message() noexcept { print("DomainError!"); print_flush(); }
 
     /**
      * @brief Prints a generic invalid argument error message to stdout.
      * Usage: mz::invalid_argument_message();
      */
-    inline void invalid_argument_message() noexcept { print("InvalidArgumentError!"); }
+    inline void invalid_argument_message() noexcept { print("InvalidArgumentError!"); print_flush(); }
 
     /**
      * @brief Prints a formatted logic error message to stdout.
@@ -78,6 +134,7 @@ namespace mz
         //print("LogicError: ");
         //print(fmt, std::forward<TArgs>(args)...);
         print("LogicError: {}", std::vformat(fmt.get(), std::make_format_args(args...)));
+        print_flush();
     }
 
     /**
@@ -92,6 +149,7 @@ namespace mz
         //print("DomainError: ");
         //print(fmt, std::forward<TArgs>(args)...);
         print("DomainError: {}", std::vformat(fmt.get(), std::make_format_args(args...)));
+        print_flush();
     }
 
     /**
@@ -106,6 +164,35 @@ namespace mz
         //print("InvalidArgumentError: ");
         //print(fmt, std::forward<TArgs>(args)...);
         print("InvalidArgumentError: {}", std::vformat(fmt.get(), std::make_format_args(args...)));
+        print_flush();
+    }
+
+    /**
+     * @brief Out-of-line throw paths of the error macros.
+     *
+     * Kept cold and never inlined, so a check costs its callers one compare and branch
+     * instead of the formatting and exception setup code.
+     */
+    [[noreturn]] MZ_COLD_NOINLINE inline void throw_logic_error() { logic_error_message(); throw std::logic_error(""); }
+    [[noreturn]] MZ_COLD_NOINLINE inline void throw_domain_error() { domain_error_message(); throw std::domain_error(""); }
+    [[noreturn]] MZ_COLD_NOINLINE inline void throw_invalid_argument() { invalid_argument_message(); throw std::invalid_argument(""); }
+
+    template <typename... TArgs>
+    [[noreturn]] MZ_COLD_NOINLINE void throw_logic_error(std::format_string<TArgs...> fmt, TArgs... args) {
+        logic_error_message(fmt, args...);
+        throw std::logic_error("");
+    }
+
+    template <typename... TArgs>
+    [[noreturn]] MZ_COLD_NOINLINE void throw_domain_error(std::format_string<TArgs...> fmt, TArgs... args) {
+        domain_error_message(fmt, args...);
+        throw std::domain_error("");
+    }
+
+    template <typename... TArgs>
+    [[noreturn]] MZ_COLD_NOINLINE void throw_invalid_argument(std::format_string<TArgs...> fmt, TArgs... args) {
+        invalid_argument_message(fmt, args...);
+        throw std::invalid_argument("");
     }
 }
 
@@ -114,7 +201,7 @@ namespace mz
  * @param Cond Condition to check.
  * Usage: THROW_IF(x < 0);
  */
-#define THROW_IF(Cond)  if (Cond) { throw std::logic_error(""); }
+#define THROW_IF(Cond)  if (Cond) [[unlikely]] { throw std::logic_error(""); }
 
  /**
   * @brief Asserts condition, prints logic error message and throws if false.
@@ -122,7 +209,7 @@ namespace mz
   * @param ... Format string and arguments for error message.
   * Usage: ASSERT_IF(ptr != nullptr, "Null pointer at {}", idx);
   */
-#define ASSERT_IF(Cond, ...)  if (!(Cond)) { mz::logic_error_message(__VA_ARGS__); throw std::logic_error(""); }
+#define ASSERT_IF(Cond, ...)  if (!(Cond)) [[unlikely]] { mz::throw_logic_error(__VA_ARGS__); }
 
   /**
    * @brief Throws std::logic_error if error condition is true, with formatted message.
@@ -130,7 +217,7 @@ namespace mz
    * @param ... Format string and arguments for error message.
    * Usage: LOGIC_ERROR_IF(failed, "Failed at {}", idx);
    */
-#define LOGIC_ERROR_IF(Error, ...)  if (Error) { mz::logic_error_message(__VA_ARGS__); throw std::logic_error(""); }
+#define LOGIC_ERROR_IF(Error, ...)  if (Error) [[unlikely]] { mz::throw_logic_error(__VA_ARGS__); }
 
    /**
     * @brief Throws std::domain_error if error condition is true, with formatted message.
@@ -138,7 +225,17 @@ namespace mz
     * @param ... Format string and arguments for error message.
     * Usage: DOMAIN_ERROR_IF(out_of_range, "Value: {}", val);
     */
-#define DOMAIN_ERROR_IF(Error, ...)  if (Error) { mz::domain_error_message(__VA_ARGS__); throw std::domain_error(""); }
+#define DOMAIN_ERROR_IF(Error, ...)  if (Error) [[unlikely]] { mz::throw_domain_error(__VA_ARGS__); }
+
+    /**
+     * @brief DOMAIN_ERROR_IF for container preconditions, subject to the MZ_CHECKS policy.
+     * Usage: CHECK_DOMAIN_ERROR_IF(size() != rhs.size(), "size mismatch: {} != {}", size(), rhs.size());
+     */
+#if MZ_CHECKS_ENABLED
+#define CHECK_DOMAIN_ERROR_IF(Error, ...)  DOMAIN_ERROR_IF(Error, __VA_ARGS__)
+#else
+#define CHECK_DOMAIN_ERROR_IF(Error, ...)  {}
+#endif
 
     /**
      * @brief Throws std::invalid_argument if error condition is true, with formatted message.
@@ -146,7 +243,7 @@ namespace mz
      * @param ... Format string and arguments for error message.
      * Usage: INVALID_ARGUMENT_IF(bad_arg, "Bad argument: {}", arg);
      */
-#define INVALID_ARGUMENT_IF(Error, ...)  if (Error) { mz::invalid_argument_message(__VA_ARGS__); throw std::invalid_argument(""); }
+#define INVALID_ARGUMENT_IF(Error, ...)  if (Error) [[unlikely]] { mz::throw_invalid_argument(__VA_ARGS__); }
 
      /**
       * @brief Debug macro: throws std::logic_error if condition is true, with formatted message.
@@ -154,7 +251,7 @@ namespace mz
       * @param ... Format string and arguments for error message.
       * Usage: DEBUG_THROW(x < 0, "Negative value: {}", x);
       */
-#define DEBUG_THROW(Cond, ...)  if (Cond) { mz::logic_error_message(__VA_ARGS__); throw std::logic_error(""); }
+#define DEBUG_THROW(Cond, ...)  if (Cond) [[unlikely]] { mz::throw_logic_error(__VA_ARGS__); }
 
       /**
        * @brief Debug macro: asserts condition, throws std::logic_error if false, with formatted message.
@@ -162,7 +259,7 @@ namespace mz
        * @param ... Format string and arguments for error message.
        * Usage: DEBUG_ASSERT(ptr != nullptr, "Null pointer");
        */
-#define DEBUG_ASSERT(Cond, ...)  if (!(Cond)) { mz::logic_error_message(__VA_ARGS__); throw std::logic_error(""); }
+#define DEBUG_ASSERT(Cond, ...)  if (!(Cond)) [[unlikely]] { mz::throw_logic_error(__VA_ARGS__); }
 
 
 
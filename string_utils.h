@@ -25,8 +25,11 @@
 #define MZLIB_STRING_UTILS_HEADER_FILE
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <format>
 #include <iostream>
+#include <string>
 #include "concept_utils.h"
 
 
@@ -75,11 +78,32 @@ namespace mz {
 
 
     /**
-     * @brief Prints a string_view to stdout.
+     * @brief Destination of mz::print other than stdout, e.g. the buffered sink of zlog.h.
+     */
+    struct PrintSink {
+        void (*write)(std::string_view) noexcept = nullptr;
+        void (*flush)() noexcept = nullptr;
+    };
+
+    inline std::atomic<const PrintSink*> print_sink{ nullptr };
+
+    /**
+     * @brief Prints a string_view to stdout (or to the installed print_sink).
      * @param sv The string_view to print.
      * Usage: mz::print("Hello\n");
      */
-    inline void print(std::string_view sv) noexcept { fwrite(sv.data(), 1, sv.size(), stdout); }
+    inline void print(std::string_view sv) noexcept {
+        if (const PrintSink* sink = print_sink.load(std::memory_order_acquire)) sink->write(sv);
+        else fwrite(sv.data(), 1, sv.size(), stdout);
+    }
+
+    /**
+     * @brief Pushes everything printed so far to its destination.
+     */
+    inline void print_flush() noexcept {
+        if (const PrintSink* sink = print_sink.load(std::memory_order_acquire)) sink->flush();
+        else fflush(stdout);
+    }
 
     /**
      * @brief Prints a formatted string to stdout.
@@ -90,7 +114,16 @@ namespace mz {
      */
     template <typename... TArgs>
     inline void print(std::format_string<TArgs...> fmt, TArgs... args) noexcept {
-        print(std::vformat(fmt.get(), std::make_format_args(args...)));
+        // Formats into a per-thread buffer that keeps its capacity; a formatter that itself
+        // prints while the buffer is in use gets a temporary string instead
+        thread_local std::string buffer;
+        thread_local bool busy = false;
+        if (busy) { print(std::vformat(fmt.get(), std::make_format_args(args...))); return; }
+        busy = true;
+        buffer.clear();
+        std::vformat_to(std::back_inserter(buffer), fmt.get(), std::make_format_args(args...));
+        busy = false;
+        print(std::string_view(buffer));
     }
 
 
@@ -131,6 +164,52 @@ namespace mz {
         }
     };
 
+    /**
+     * @brief Base of the std::formatter specializations for containers (Vector, Span, Slice).
+     *
+     * The format spec applies to the elements, e.g. std::format("{:.2f}", vec) gives
+     * "[1.00,2.50]". It is parsed once by the element's own std::formatter, and every element
+     * is then written straight into ctx.out(), so formatting allocates nothing. Elements
+     * without a std::formatter use format_to(out, fmt) (HasFormatTo) or, failing that,
+     * string(fmt) (HasFormatString) with the stored format string.
+     */
+    template <typename T>
+    struct sequence_formatter : basic_formatter16 {
+        using element_formatter = std::conditional_t<StdFormattable<T>, std::formatter<T, char>, basic_formatter16>;
+        element_formatter element_;
+
+        constexpr auto parse(auto& ctx) {
+            if constexpr (StdFormattable<T>) {
+                return element_.parse(ctx);
+            }
+            else {
+                return basic_formatter16::parse(ctx);
+            }
+        }
+
+        template <typename Seq>
+        auto format_sequence(Seq const& seq, auto& ctx) const {
+            auto out = ctx.out();
+            *out++ = '[';
+            for (decltype(seq.size()) i = 0; i < seq.size(); i++) {
+                if (i) *out++ = ',';
+                if constexpr (StdFormattable<T>) {
+                    ctx.advance_to(out);
+                    out = element_.format(seq[i], ctx);
+                }
+                else if constexpr (HasFormatTo<T>) {
+                    out = seq[i].format_to(out, std::string_view{ FMT, size_t{ count } });
+                }
+                else {
+                    std::string const s = seq[i].string(std::string_view{ FMT, size_t{ count } });
+                    out = std::copy(s.begin(), s.end(), out);
+                }
+            }
+            *out++ = ']';
+            return out;
+        }
+    };
+
 
 
 
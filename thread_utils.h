@@ -0,0 +1,182 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_THREAD_UTILS_HEADER_FILE
+#define MZ_THREAD_UTILS_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file thread_utils.h
+ * @brief A small persistent worker pool with a blocking parallel_for.
+ *
+ * This header defines:
+ *   - mz::ThreadPool: fixed set of worker threads that run index ranges.
+ *   - mz::parallel_for: runs body(i) for i in [0, count) on the shared pool.
+ *
+ * The calling thread takes part in the work, and parallel_for returns only when every
+ * index has run. Calls made from inside a pool task run serially on the calling thread,
+ * so nested use never deadlocks. The body must not throw.
+ *
+ * Usage example:
+ *   mz::parallel_for(blocks.size(), [&](size_t i) { compress(blocks[i]); });
+ */
+
+namespace mz {
+
+    /**
+     * @brief Fixed-size worker pool; one parallel_for runs at a time per pool.
+     */
+    class ThreadPool {
+        std::vector<std::thread> workers_;
+        std::mutex mutex_;                       // guards the job fields below
+        std::mutex call_mutex_;                  // serializes parallel_for callers
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        const std::function<void(size_t)>* body_ = nullptr;
+        size_t count_ = 0;
+        std::atomic<size_t> next_{ 0 };
+        size_t pending_ = 0;                     // workers still inside the current job
+        uint64_t generation_ = 0;
+        bool stop_ = false;
+
+        static bool& inside_worker() noexcept {
+            thread_local bool inside = false;
+            return inside;
+        }
+
+        /**
+         * @brief Marks the calling thread as running pool tasks for its lifetime.
+         */
+        struct InsideScope {
+            bool previous = inside_worker();
+            InsideScope() noexcept { inside_worker() = true; }
+            ~InsideScope() { inside_worker() = previous; }
+        };
+
+        void drain() noexcept {
+            for (size_t i = next_.fetch_add(1); i < count_; i = next_.fetch_add(1)) (*body_)(i);
+        }
+
+        void work() noexcept {
+            inside_worker() = true;
+            uint64_t seen{ 0 };
+            for (;;) {
+                {
+                    std::unique_lock lock(mutex_);
+                    wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                    if (stop_) return;
+                    seen = generation_;
+                }
+                drain();
+                std::lock_guard lock(mutex_);
+                if (--pending_ == 0) done_.notify_one();
+            }
+        }
+
+    public:
+        /**
+         * @brief Starts threads - 1 workers (the caller of parallel_for is the last one).
+         * @param threads Total parallelism; 0 selects std::thread::hardware_concurrency().
+         */
+        explicit ThreadPool(unsigned threads = 0) {
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned i = 1; i < threads; i++) workers_.emplace_back([this] { work(); });
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (auto& worker : workers_) worker.join();
+        }
+
+        /**
+         * @brief Number of threads that take part in a parallel_for, including the caller.
+         */
+        size_t size() const noexcept { return workers_.size() + 1; }
+
+        /**
+         * @brief Runs body(i) for every i in [0, count) and waits for all of them.
+         */
+        void parallel_for(size_t count, const std::function<void(size_t)>& body) noexcept {
+            if (count == 0) return;
+            if (workers_.empty() || count == 1 || inside_worker()) {
+                for (size_t i = 0; i < count; i++) body(i);
+                return;
+            }
+            std::lock_guard call(call_mutex_);
+            {
+                std::lock_guard lock(mutex_);
+                body_ = &body;
+                count_ = count;
+                next_.store(0);
+                pending_ = workers_.size();
+                ++generation_;
+            }
+            wake_.notify_all();
+            {
+                InsideScope inside;              // the caller's share of the work may nest too
+                drain();
+            }
+            std::unique_lock lock(mutex_);
+            done_.wait(lock, [&] { return pending_ == 0; });
+            body_ = nullptr;
+        }
+
+        /**
+         * @brief Process-wide pool sized to the hardware, created on first use.
+         */
+        static ThreadPool& shared() {
+            static ThreadPool pool;
+            return pool;
+        }
+    };
+
+    /**
+     * @brief Runs body(i) for every i in [0, count) on the shared pool.
+     *
+     * Usage:
+     *   mz::parallel_for(n, [&](size_t i) { out[i] = f(in[i]); });
+     */
+    inline void parallel_for(size_t count, const std::function<void(size_t)>& body) noexcept {
+        ThreadPool::shared().parallel_for(count, body);
+    }
+
+} // namespace mz
+
+#endif // MZ_THREAD_UTILS_HEADER_FILE
@@ -26,8 +26,27 @@
 #pragma once
 
 #include <time.h>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <concepts>
+#include <forward_list>
 #include <iostream>
 #include <format>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MZ_TIMER_HAS_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
+#else
+#define MZ_TIMER_HAS_TSC 0
+#endif
 
 namespace mz {
 
@@ -48,14 +67,267 @@ namespace mz {
     }
 
     /**
- * @class Timer
- * @brief A utility class for measuring time durations.
- *
- * This class provides functionality to measure elapsed time between events
- * and accumulate total durations. It supports high-resolution timing and
- * provides formatted string representations of the measured durations.
- */
-    class Timer {
+     * @brief Wall clock (`timespec_get(TIME_UTC)`). Not monotonic: it jumps with NTP and
+     *        manual adjustments. Kept as the default of `Timer` for compatibility.
+     */
+    struct WallClock {
+        static constexpr const char* name = "wall";
+
+        /**
+         * @brief Current time in nanoseconds since the epoch.
+         * @throws std::runtime_error If `timespec_get` fails.
+         */
+        static int64_t now() {
+            struct timespec ts;
+            if (timespec_get(&ts, TIME_UTC) == 0) {
+                throw std::runtime_error("Failed to retrieve the current time using timespec_get.");
+            }
+            return static_cast<int64_t>(ts.tv_sec) * 1000000000ll + ts.tv_nsec;
+        }
+    };
+
+    /**
+     * @brief `std::chrono::steady_clock`. Monotonic and portable.
+     */
+    struct SteadyClock {
+        static constexpr const char* name = "steady";
+
+        static int64_t now() noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    };
+
+    /**
+     * @brief `CLOCK_MONOTONIC_RAW`: monotonic and not slewed by NTP. Falls back to
+     *        `SteadyClock` on platforms without it.
+     */
+    struct MonotonicRawClock {
+        static constexpr const char* name = "monotonic_raw";
+
+        static int64_t now() noexcept {
+#if defined(CLOCK_MONOTONIC_RAW)
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+            return static_cast<int64_t>(ts.tv_sec) * 1000000000ll + ts.tv_nsec;
+#else
+            return SteadyClock::now();
+#endif
+        }
+    };
+
+    /**
+     * @brief Time stamp counter clock for timing short regions.
+     *
+     * On x86-64 with an invariant TSC, `now()` reads the counter with `lfence; rdtsc; lfence`
+     * so the read neither starts before earlier instructions retire nor lets later ones
+     * start early, and converts ticks to nanoseconds with a fixed-point factor measured
+     * against `steady_clock` on first use. `start()`/`stop()` give the cheaper bracket
+     * pair (`lfence; rdtsc` before the region, `rdtscp; lfence` after it).
+     *
+     * Without an invariant TSC (or on other architectures) every call falls back to
+     * `SteadyClock`; check `available()`.
+     */
+    struct TscClock {
+        static constexpr const char* name = "tsc";
+
+        /**
+         * @brief Calibration state: tick origin and a 32.32 fixed-point ns-per-tick factor.
+         */
+        struct Calibration {
+            uint64_t base_ticks = 0;
+            int64_t base_ns = 0;
+            uint64_t ns_per_tick_q32 = 0;
+            double ticks_per_ns = 0;
+            bool available = false;
+        };
+
+        /**
+         * @brief True when the CPU reports an invariant TSC.
+         */
+        static bool invariant() noexcept {
+#if MZ_TIMER_HAS_TSC
+            unsigned int regs[4]{};
+            cpuid(regs, 0x80000000u);
+            if (regs[0] < 0x80000007u) return false;
+            cpuid(regs, 0x80000007u);
+            return (regs[3] & (1u << 8)) != 0;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         * @brief Raw counter read, serialized on both sides.
+         */
+        static uint64_t ticks() noexcept {
+#if MZ_TIMER_HAS_TSC
+            _mm_lfence();
+            uint64_t t = __rdtsc();
+            _mm_lfence();
+            return t;
+#else
+            return static_cast<uint64_t>(SteadyClock::now());
+#endif
+        }
+
+        /**
+         * @brief Counter read for the start of a region: waits for earlier instructions only.
+         */
+        static uint64_t start_ticks() noexcept {
+#if MZ_TIMER_HAS_TSC
+            _mm_lfence();
+            return __rdtsc();
+#else
+            return static_cast<uint64_t>(SteadyClock::now());
+#endif
+        }
+
+        /**
+         * @brief Counter read for the end of a region: `rdtscp` waits for the region to
+         *        retire, the trailing fence keeps later code out of the measurement.
+         */
+        static uint64_t stop_ticks() noexcept {
+#if MZ_TIMER_HAS_TSC
+            unsigned int aux;
+            uint64_t t = __rdtscp(&aux);
+            _mm_lfence();
+            return t;
+#else
+            return static_cast<uint64_t>(SteadyClock::now());
+#endif
+        }
+
+        /**
+         * @brief Measures the tick rate against `steady_clock` over @p duration.
+         *        Runs automatically (10 ms) on first use; call again to refine.
+         *
+         * Each call publishes a new immutable Calibration with one atomic pointer store, so
+         * it may run while other threads convert ticks. Readers see either the old or the new
+         * calibration, never a mix; superseded ones stay allocated until exit.
+         */
+        static const Calibration& calibrate(std::chrono::nanoseconds duration = std::chrono::milliseconds(10)) noexcept {
+            Calibration c;
+            c.available = invariant();
+            if (MZ_TIMER_HAS_TSC) {    // measure the rate even without invariance, for ticks_to_ns
+                // Bracket each steady_clock read by two counter reads and keep the tightest
+                // bracket at each end, which bounds the error by a few tens of ticks.
+                auto sample = [](int64_t& ns, uint64_t& tick) {
+                    uint64_t best = UINT64_MAX;
+                    for (int i = 0; i < 16; ++i) {
+                        uint64_t t0 = ticks();
+                        int64_t n = SteadyClock::now();
+                        uint64_t t1 = ticks();
+                        if (t1 - t0 < best) { best = t1 - t0; ns = n; tick = t0 + (t1 - t0) / 2; }
+                    }
+                };
+                int64_t ns0 = 0, ns1 = 0;
+                uint64_t t0 = 0, t1 = 0;
+                sample(ns0, t0);
+                while (SteadyClock::now() - ns0 < duration.count()) {}
+                sample(ns1, t1);
+                double const ns_per_tick = static_cast<double>(ns1 - ns0) / static_cast<double>(t1 - t0);
+                c.base_ticks = t0;
+                c.base_ns = ns0;
+                c.ns_per_tick_q32 = static_cast<uint64_t>(ns_per_tick * 4294967296.0);
+                c.ticks_per_ns = 1.0 / ns_per_tick;
+            }
+            static std::mutex mutex;
+            static std::forward_list<Calibration> published;    // keeps every calibration readers may hold
+            std::lock_guard lock(mutex);
+            published.push_front(c);
+            current().store(&published.front(), std::memory_order_release);
+            return published.front();
+        }
+
+        /**
+         * @brief Current calibration, running `calibrate()` on first call.
+         */
+        static const Calibration& calibration() noexcept {
+            static const bool once = (calibrate(), true);
+            (void)once;
+            return *current().load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief True when the TSC path is in use (invariant TSC found at calibration).
+         */
+        static bool available() noexcept { return calibration().available; }
+
+        /**
+         * @brief Counter frequency in GHz (ticks per nanosecond), 0 when unavailable.
+         */
+        static double ticks_per_ns() noexcept { return calibration().ticks_per_ns; }
+
+        /**
+         * @brief Converts a counter value to nanoseconds on the `steady_clock` time line.
+         */
+        static int64_t to_ns(uint64_t t) noexcept {
+            const Calibration& c = calibration();
+            if (!c.ns_per_tick_q32) return static_cast<int64_t>(t);
+            int64_t const d = static_cast<int64_t>(t - c.base_ticks);
+            return c.base_ns + mul_q32(d, c.ns_per_tick_q32);
+        }
+
+        /**
+         * @brief Converts a difference of ticks()/start_ticks()/stop_ticks() values to nanoseconds.
+         */
+        static int64_t ticks_to_ns(int64_t d) noexcept {
+            const Calibration& c = calibration();
+            return c.ns_per_tick_q32 ? mul_q32(d, c.ns_per_tick_q32) : d;
+        }
+
+        static int64_t now() noexcept {
+            return available() ? to_ns(ticks()) : SteadyClock::now();
+        }
+
+    private:
+        static std::atomic<const Calibration*>& current() noexcept {
+            static std::atomic<const Calibration*> c{ nullptr };
+            return c;
+        }
+
+        static int64_t mul_q32(int64_t d, uint64_t q) noexcept {
+#if defined(__SIZEOF_INT128__)
+            return static_cast<int64_t>((static_cast<__int128>(d) * static_cast<__int128>(q)) >> 32);
+#else
+            return static_cast<int64_t>(static_cast<double>(d) * (static_cast<double>(q) / 4294967296.0));
+#endif
+        }
+
+#if MZ_TIMER_HAS_TSC
+        static void cpuid(unsigned int regs[4], unsigned int leaf) noexcept {
+#if defined(_MSC_VER)
+            __cpuid(reinterpret_cast<int*>(regs), static_cast<int>(leaf));
+#else
+            __cpuid(leaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+        }
+#endif
+    };
+
+    /**
+     * @brief Requirements for a Timer clock backend.
+     */
+    template <typename C>
+    concept TimerClock = requires {
+        { C::now() } -> std::convertible_to<int64_t>;
+        { C::name } -> std::convertible_to<const char*>;
+    };
+
+    /**
+     * @class TimerT
+     * @brief A utility class for measuring time durations.
+     *
+     * This class provides functionality to measure elapsed time between events
+     * and accumulate total durations. It supports high-resolution timing and
+     * provides formatted string representations of the measured durations.
+     *
+     * @tparam Clock Clock backend: WallClock (default, as `Timer`), SteadyClock,
+     *         MonotonicRawClock or TscClock.
+     */
+    template <TimerClock Clock>
+    class TimerT {
         // Constants for time conversions
         static constexpr int64_t kNanosecondsPerMillisecond = 1000000ll; // 1 million (for milliseconds)
         static constexpr int64_t kNanosecondsPerSecond = 1000000000ll; // 1 billion (for seconds)
@@ -64,30 +336,78 @@ namespace mz {
         int64_t last_interval_ns = 0;    // Duration of the last measured interval (in nanoseconds)
         int64_t total_elapsed_ns = 0;   // Accumulated total duration (in nanoseconds)
         int64_t last_timestamp_ns = 0;   // Timestamp of the last measurement (in nanoseconds)
+        void (*sink_fn)(void*, int64_t) = nullptr; // Receives each interval (see attach)
+        void* sink_ctx = nullptr;
 
     public:
+        using clock_type = Clock;
+
         /**
          * @brief Default constructor.
          * Initializes the timer and sets the initial timestamp.
-         * @throws std::runtime_error If `timespec_get` fails.
+         * @throws std::runtime_error If the clock fails.
          */
-        Timer() : last_interval_ns(0), total_elapsed_ns(0), last_timestamp_ns(now()) {}
+        TimerT() : last_interval_ns(0), total_elapsed_ns(0), last_timestamp_ns(now()) {}
 
         /**
-         * @brief Gets the current time in nanoseconds.
-         *
-         * This function retrieves the current time using `timespec_get` and converts
-         * it to nanoseconds for high-resolution timing.
+         * @brief Gets the current time of the clock backend in nanoseconds.
          *
          * @return int64_t The current time in nanoseconds.
-         * @throws std::runtime_error If `timespec_get` fails.
+         * @throws std::runtime_error If the clock fails (WallClock only).
          */
         int64_t now() const {
-            struct timespec ts;
-            if (timespec_get(&ts, TIME_UTC) == 0) {
-                throw std::runtime_error("Failed to retrieve the current time using timespec_get.");
-            }
-            return ts.tv_sec * kNanosecondsPerSecond + ts.tv_nsec;
+            return Clock::now();
+        }
+
+        /**
+         * @brief Cost of one `now()` call in nanoseconds: the minimum over many back-to-back
+         *        pairs, measured once per clock. Subtract it from intervals of a few hundred
+         *        nanoseconds or less.
+         */
+        static int64_t overhead_ns() {
+            static const int64_t overhead = [] {
+                int64_t best = INT64_MAX;
+                for (int i = 0; i < 1000; ++i) {
+                    int64_t t0 = Clock::now();
+                    int64_t t1 = Clock::now();
+                    best = (std::min)(best, t1 - t0);
+                }
+                return best;
+            }();
+            return overhead;
+        }
+
+        /**
+         * @brief Feeds every interval measured by stamp() (in nanoseconds) to @p sink,
+         *        e.g. a LatencyHistogram. The sink must outlive the timer or be detached.
+         */
+        template <typename Sink>
+            requires requires(Sink& sink, int64_t ns) { sink.record(ns); }
+        void attach(Sink& sink) noexcept {
+            sink_ctx = &sink;
+            sink_fn = [](void* ctx, int64_t ns) { static_cast<Sink*>(ctx)->record(ns); };
+        }
+
+        /**
+         * @brief Stops feeding intervals to the attached sink.
+         */
+        void detach() noexcept {
+            sink_fn = nullptr;
+            sink_ctx = nullptr;
+        }
+
+        /**
+         * @brief Gets the duration of the last measured interval in nanoseconds.
+         */
+        constexpr int64_t last_ns() const noexcept {
+            return last_interval_ns;
+        }
+
+        /**
+         * @brief Gets the accumulated total duration in nanoseconds.
+         */
+        constexpr int64_t total_ns() const noexcept {
+            return total_elapsed_ns;
         }
 
         /**
@@ -122,8 +442,10 @@ namespace mz {
         /**
          * @brief Stops the current timing interval and updates the durations.
          *
-         * This function calculates the duration of the current interval, adds it
-         * to the total duration, and returns the last duration in seconds.
+         * This function calculates the duration of the interval since the previous
+         * `stamp()` (or `reset()`/construction), adds it to the total duration,
+         * passes it to the attached sink (if any), starts the next interval and
+         * returns the last duration in seconds.
          *
          * @return double The last duration in seconds.
          * @throws std::runtime_error If `now` fails.
@@ -131,7 +453,9 @@ namespace mz {
         double stamp() {
             int64_t NextTimeStamp = now(); // Get the current time
             last_interval_ns = NextTimeStamp - last_timestamp_ns; // Calculate the interval
+            last_timestamp_ns = NextTimeStamp; // Start the next interval
             total_elapsed_ns += last_interval_ns; // Accumulate the total duration
+            if (sink_fn) sink_fn(sink_ctx, last_interval_ns); // Feed the attached histogram
             return last_seconds(); // Return the last duration in seconds
         }
 
@@ -145,7 +469,7 @@ namespace mz {
          */
         std::string string() const noexcept {
             return std::format(
-                "Last: {}.{:<3d} sec, Total: {}.{:<3d} sec",
+                "Last: {}.{:03d} sec, Total: {}.{:03d} sec",
                 (last_interval_ns / kNanosecondsPerSecond), (last_interval_ns % kNanosecondsPerSecond) / kNanosecondsPerMillisecond,
                 (total_elapsed_ns / kNanosecondsPerSecond), (total_elapsed_ns % kNanosecondsPerSecond) / kNanosecondsPerMillisecond
             );
@@ -167,6 +491,26 @@ namespace mz {
         }
     };
 
+    using Timer = TimerT<WallClock>;                  ///< Wall-clock timer (original behavior).
+    using SteadyTimer = TimerT<SteadyClock>;          ///< Monotonic, portable.
+    using MonotonicTimer = TimerT<MonotonicRawClock>; ///< CLOCK_MONOTONIC_RAW, not NTP-slewed.
+    using TscTimer = TimerT<TscClock>;                ///< Invariant TSC with fences.
+
+    /**
+     * @brief Measures a short region with the TSC bracket pair and returns its duration in ticks.
+     *
+     * Usage:
+     *   int64_t ticks = mz::tsc_measure([&] { x = f(x); });
+     *   int64_t ns = mz::TscClock::ticks_to_ns(ticks);
+     */
+    template <typename F>
+    int64_t tsc_measure(F&& f) {
+        uint64_t const t0 = TscClock::start_ticks();
+        f();
+        uint64_t const t1 = TscClock::stop_ticks();
+        return static_cast<int64_t>(t1 - t0);
+    }
+
 
 
 
@@ -183,9 +527,10 @@ namespace mz {
  * @param d The Duration object.
  * @return std::ostream& The output stream.
  */
-inline std::ostream& operator<<(std::ostream& os, mz::Timer& d) {
+template <typename Clock>
+inline std::ostream& operator<<(std::ostream& os, mz::TimerT<Clock>& d) {
     d.stamp(); // Stamp the current interval
     return os << d.string(); // Output the formatted string
 }
 
-#endif // MZ_TIMER_UTILS_HEADER_FILE
\ No newline at end of file
+#endif // MZ_TIMER_UTILS_HEADER_FILE
@@ -0,0 +1,344 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_ARCHIVE_HEADER_FILE
+#define MZ_ARCHIVE_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "globals.h"
+#include "zstream.h"
+#include "zmmap.h"
+#include "zchecksum.h"
+
+/**
+ * @file zarchive.h
+ * @brief Random-access container file: named, labelled sections located through a footer index.
+ *
+ * This header defines:
+ *   - mz::ArchiveEntry: name, label, offset and length of one section.
+ *   - mz::Archive: appends sections to a file and loads any one of them without scanning.
+ *
+ * File layout:
+ *   "MZARCHV1" | { section payloads ... | index | footer } ...
+ *   index:  u32 entry count, then per entry: u32 name length, name bytes, u64 label,
+ *           u64 offset, u64 length
+ *   footer: u64 index offset | u32 crc32c(index) | u32 version | "MZARCHV1"   (24 bytes)
+ *
+ * New sections are written after the last footer and each commit appends a new index and
+ * footer, so appending never touches bytes an earlier commit wrote. Until the next commit
+ * the previous footer stays valid: if the process dies (or a saver throws) in between,
+ * opening the file falls back to the last footer whose index checksum matches and the
+ * uncommitted sections are dropped. Superseded indexes, and sections shadowed by a later
+ * one with the same name, stay in the file as dead bytes. Loads go through a read-only
+ * mapping of the file, so a section's pages are touched only when it is read.
+ *
+ * Usage example:
+ *   {
+ *       mz::Archive ar("run.mza");
+ *       ar.save("weights", weights, WeightsLabel);
+ *       ar.save("ids", ids);
+ *   }                                  // destructor commits the index
+ *   mz::Archive ar("run.mza");
+ *   mz::XA ids;
+ *   if (ar.load("ids", ids)) { ... }   // true if missing or malformed
+ */
+
+namespace mz {
+
+    /**
+     * @brief Index record of one archive section.
+     */
+    struct ArchiveEntry {
+        std::string name;
+        uint64_t label = 0;
+        uint64_t offset = 0;   // from the start of the file
+        uint64_t length = 0;   // payload bytes
+    };
+
+    /**
+     * @brief Appendable archive of named sections with a footer index.
+     *
+     * Sections are written through a FileStream and read through an MmapStream that is
+     * (re)mapped after each commit. Not thread-safe.
+     */
+    class Archive {
+        static constexpr uint64_t magic = 0x3156484352415A4Dull; // "MZARCHV1"
+        static constexpr uint32_t version = 1;
+        static constexpr int64_t footer_bytes = 24;
+
+        std::string path_;
+        FileStream file_;
+        std::vector<ArchiveEntry> entries_;
+        uint64_t data_end_ = sizeof(magic);      // where the next section (or the index) goes
+        bool dirty_ = false;
+        std::unique_ptr<MmapStream> map_;
+
+        /**
+         * @brief Loads the index whose footer ends at byte `end`; false if there is no valid one there.
+         */
+        bool read_index_at(int64_t end) {
+            if (end < static_cast<int64_t>(sizeof(magic)) + footer_bytes) return false;
+            uint64_t index_offset{ 0 }, tail{ 0 };
+            uint32_t crc{ 0 }, file_version{ 0 };
+            file_.seek(end - footer_bytes);
+            file_ >> index_offset >> crc >> file_version >> tail;
+            if (file_.failed() || tail != magic || file_version != version) return false;
+            if (index_offset < sizeof(magic) || index_offset > static_cast<uint64_t>(end - footer_bytes)) return false;
+
+            std::vector<char> index(static_cast<size_t>(end - footer_bytes - static_cast<int64_t>(index_offset)));
+            file_.seek(static_cast<int64_t>(index_offset));
+            file_.read(index.data(), static_cast<int>(index.size()));
+            if (file_.failed() || crc32c(index.data(), index.size()) != crc) return false;
+
+            size_t pos{ 0 };
+            auto take = [&](auto& value) {
+                if (index.size() - pos < sizeof(value)) return false;
+                memcpy(&value, index.data() + pos, sizeof(value));
+                pos += sizeof(value);
+                return true;
+            };
+            uint32_t count{ 0 };
+            if (!take(count)) return false;
+            std::vector<ArchiveEntry> entries(count);
+            for (auto& entry : entries) {
+                uint32_t length{ 0 };
+                if (!take(length) || index.size() - pos < length) return false;
+                entry.name.assign(index.data() + pos, length);
+                pos += length;
+                if (!take(entry.label) || !take(entry.offset) || !take(entry.length)) return false;
+            }
+            entries_ = std::move(entries);
+            return true;
+        }
+
+        /**
+         * @brief End of the last valid footer before `size`, or 0 if there is none.
+         *
+         * Only needed when the file ends in sections that were never committed.
+         */
+        int64_t find_footer(int64_t size) {
+            constexpr int64_t block_bytes = int64_t{ 1 } << 20;
+            constexpr int64_t first = static_cast<int64_t>(sizeof(magic));
+            std::vector<char> block;
+            for (int64_t hi = size; hi > first; ) {
+                int64_t const lo = std::max(first, hi - block_bytes);
+                int64_t const top = std::min(size, hi + first - 1);  // a magic may straddle two blocks
+                block.resize(static_cast<size_t>(top - lo));
+                file_.seek(lo);
+                file_.read(block.data(), static_cast<int>(block.size()));
+                if (file_.failed()) return 0;
+                for (int64_t pos = top - first; pos >= lo; --pos) {
+                    if (memcmp(block.data() + (pos - lo), &magic, sizeof(magic)) == 0 && read_index_at(pos + first)) return pos + first;
+                }
+                hi = lo;
+            }
+            return 0;
+        }
+
+        void read_index() {
+            file_.end();
+            int64_t const size = file_.tell();
+            if (size == 0) {
+                file_.seek(0);
+                file_.write(magic);
+                dirty_ = true;
+                return;
+            }
+            uint64_t head{ 0 };
+            file_.seek(0);
+            file_.read(head);
+            DOMAIN_ERROR_IF(head != magic || size < static_cast<int64_t>(sizeof(magic)) + footer_bytes, "Archive: {} is not an archive", path_);
+            int64_t const end = read_index_at(size) ? size : find_footer(size);
+            DOMAIN_ERROR_IF(end == 0, "Archive: {} has no valid index", path_);
+            data_end_ = static_cast<uint64_t>(end);
+        }
+
+        MmapStream& mapped() {
+            if (dirty_) commit();
+            if (!map_) map_ = std::make_unique<MmapStream>(path_);
+            return *map_;
+        }
+
+    public:
+        /**
+         * @brief Opens an archive, creating an empty one if the file does not exist.
+         * @throws std::domain_error if the file exists but is not a valid archive.
+         */
+        explicit Archive(std::string path) : path_(std::move(path)), file_(path_) { read_index(); }
+
+        Archive(const Archive&) = delete;
+        Archive& operator=(const Archive&) = delete;
+
+        /**
+         * @brief Commits pending sections; errors are printed rather than thrown from the destructor.
+         *
+         * A failed commit leaves the previous index in place, so only the pending sections are lost.
+         */
+        ~Archive() {
+            try { if (dirty_) commit(); }
+            catch (const std::exception& e) { print("Archive: pending sections of {} were not committed: {}\n", path_, e.what()); print_flush(); }
+            catch (...) { print("Archive: pending sections of {} were not committed\n", path_); print_flush(); }
+        }
+
+        const std::vector<ArchiveEntry>& entries() const noexcept { return entries_; }
+
+        /**
+         * @brief Latest section with the given name, or nullptr.
+         */
+        const ArchiveEntry* find(std::string_view name) const noexcept {
+            for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+                if (it->name == name) return &*it;
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief Latest section with the given label, or nullptr.
+         */
+        const ArchiveEntry* find(uint64_t label) const noexcept {
+            for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+                if (it->label == label) return &*it;
+            }
+            return nullptr;
+        }
+
+        bool contains(std::string_view name) const noexcept { return find(name) != nullptr; }
+
+        /**
+         * @brief Appends a section whose payload is produced by saver(Stream&).
+         * @throws std::domain_error if the file could not be written.
+         *
+         * Usage:
+         *   ar.add("header", 0, [&](mz::Stream& s) { s << version << count; });
+         */
+        template <typename Saver>
+            requires std::invocable<Saver, Stream&>
+        void add(std::string name, uint64_t label, Saver&& saver) {
+            map_.reset();
+            file_.seek(static_cast<int64_t>(data_end_)); // fstream shares one position for get and put
+            saver(static_cast<Stream&>(file_));
+            file_.flush();
+            int64_t const end = file_.tell();
+            DOMAIN_ERROR_IF(file_.failed() || end < static_cast<int64_t>(data_end_), "Archive: cannot write section {} to {}", name, path_);
+            entries_.push_back({ std::move(name), label, data_end_, static_cast<uint64_t>(end) - data_end_ });
+            data_end_ = static_cast<uint64_t>(end);
+            dirty_ = true;
+        }
+
+        /**
+         * @brief Appends obj.save(Stream&) as a section.
+         */
+        template <typename T>
+            requires requires(const T& obj, Stream& s) { obj.save(s); }
+        void save(std::string name, const T& obj, uint64_t label = 0) {
+            add(std::move(name), label, [&](Stream& s) { obj.save(s); });
+        }
+
+        /**
+         * @brief Writes a new index and footer after the last section.
+         * @throws std::domain_error if the file could not be written.
+         *
+         * Bytes past the new footer (sections left behind by an interrupted session) are cut off.
+         */
+        void commit() {
+            std::vector<char> index;
+            auto put = [&](const void* ptr, size_t size) {
+                index.insert(index.end(), static_cast<const char*>(ptr), static_cast<const char*>(ptr) + size);
+            };
+            uint32_t const count = static_cast<uint32_t>(entries_.size());
+            put(&count, sizeof(count));
+            for (auto const& entry : entries_) {
+                uint32_t const length = static_cast<uint32_t>(entry.name.size());
+                put(&length, sizeof(length));
+                put(entry.name.data(), length);
+                put(&entry.label, sizeof(entry.label));
+                put(&entry.offset, sizeof(entry.offset));
+                put(&entry.length, sizeof(entry.length));
+            }
+            map_.reset();
+            file_.seek(static_cast<int64_t>(data_end_));
+            file_.write(index.data(), static_cast<int>(index.size()));
+            file_ << data_end_ << crc32c(index.data(), index.size()) << version << magic;
+            file_.flush();
+            DOMAIN_ERROR_IF(file_.failed(), "Archive: cannot write the index of {}", path_);
+            data_end_ += index.size() + footer_bytes;
+            dirty_ = false;
+            std::error_code ec;
+            if (std::filesystem::file_size(path_, ec) > data_end_ && !ec) std::filesystem::resize_file(path_, data_end_, ec);
+        }
+
+        /**
+         * @brief Loads a section with loader(Stream&) -> bool (true on error, like load3).
+         *
+         * The stream is a mapping of the file positioned at the section start.
+         * @return true if the section is missing, the loader failed, or it read past the section.
+         */
+        template <typename Loader>
+            requires requires(Loader&& loader, Stream& s) { { loader(s) } -> std::same_as<bool>; }
+        bool read(std::string_view name, Loader&& loader) {
+            const ArchiveEntry* entry = find(name);
+            if (!entry) return true;
+            MmapStream& map = mapped();
+            map.seek(static_cast<int64_t>(entry->offset));
+            if (loader(static_cast<Stream&>(map))) return true;
+            return map.failed() || map.position() > entry->offset + entry->length;
+        }
+
+        /**
+         * @brief Loads obj.load(Stream&) from a section; true if missing or malformed.
+         */
+        template <typename T>
+            requires requires(T& obj, Stream& s) { obj.load(s); }
+        bool load(std::string_view name, T& obj) {
+            return read(name, [&](Stream& s) {
+                if constexpr (std::same_as<decltype(obj.load(s)), bool>) return obj.load(s);
+                else { obj.load(s); return false; }
+            });
+        }
+
+        /**
+         * @brief Zero-copy view of a section's raw payload bytes (valid until the next add/commit).
+         *
+         * A std::span, since sections may pass 2 GiB. Empty if the section is missing or
+         * its index entry points outside the file.
+         */
+        std::span<const char> bytes(std::string_view name) {
+            const ArchiveEntry* entry = find(name);
+            if (!entry) return {};
+            std::span<const char> const file = mapped().bytes();
+            if (entry->offset > file.size() || entry->length > file.size() - entry->offset) return {};
+            return file.subspan(static_cast<size_t>(entry->offset), static_cast<size_t>(entry->length));
+        }
+    };
+
+} // namespace mz
+
+#endif // MZ_ARCHIVE_HEADER_FILE
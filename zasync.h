@@ -0,0 +1,247 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_ASYNC_STREAM_HEADER_FILE
+#define MZ_ASYNC_STREAM_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "globals.h"
+#include "zstream.h"
+
+/**
+ * @file zasync.h
+ * @brief Write-behind Stream decorator that overlaps serialization with disk writes.
+ *
+ * This header defines:
+ *   - mz::AsyncStream: double-buffered decorator; the caller fills one buffer while a
+ *     background thread writes the other to the inner stream.
+ *
+ * The caller only blocks when both buffers are full (back-pressure), so a checkpoint costs
+ * roughly the memcpy into the buffers plus whatever the disk cannot absorb in the meantime.
+ * flush() and close() wait until every byte has reached the inner stream; a failure of the
+ * inner stream is recorded by the writer thread and reported by failed(), and close()
+ * throws it.
+ *
+ * Usage example:
+ *   mz::FileStream file("checkpoint.bin");
+ *   mz::AsyncStream async(file);
+ *   solver_state.save(async);        // returns once the data is buffered
+ *   ...                              // keep computing
+ *   async.close();                   // waits; throws std::domain_error if a write failed
+ */
+
+namespace mz {
+
+    /**
+     * @brief Double-buffered write-behind decorator; the decorator does not own the inner stream.
+     *
+     * Writes are asynchronous. Every other operation (reads, seeks, write_position/overwrite,
+     * begin/end, save/load) first waits for pending writes and then forwards to the inner
+     * stream on the calling thread. rdbuf() returns the inner buffer without waiting; call
+     * flush() first.
+     */
+    class AsyncStream final : public Stream {
+        Stream& inner_;
+        std::vector<char> front_;                // filled by the caller
+        std::vector<char> back_;                 // written by the worker while busy_
+        size_t front_len_ = 0;
+        size_t back_len_ = 0;
+
+        mutable std::mutex mutex_;
+        mutable std::condition_variable cv_;
+        bool busy_ = false;                      // back_ holds data the worker has not written yet
+        bool stop_ = false;
+        bool failed_ = false;
+        uint64_t stalls_ = 0;                    // times a writer waited on back-pressure
+        std::thread worker_;
+
+        void run() noexcept {
+            std::unique_lock lock(mutex_);
+            for (;;) {
+                cv_.wait(lock, [&] { return stop_ || busy_; });
+                if (!busy_) return;
+                lock.unlock();
+                inner_.write(back_.data(), static_cast<int>(back_len_));
+                bool const bad = inner_.failed();
+                lock.lock();
+                failed_ = failed_ || bad;
+                busy_ = false;
+                cv_.notify_all();
+            }
+        }
+
+        // Hands the front buffer to the worker, waiting while it is still busy with the back one
+        void submit() noexcept {
+            if (!front_len_) return;
+            std::unique_lock lock(mutex_);
+            if (busy_) {
+                ++stalls_;
+                cv_.wait(lock, [&] { return !busy_; });
+            }
+            std::swap(front_, back_);
+            back_len_ = front_len_;
+            front_len_ = 0;
+            busy_ = true;
+            lock.unlock();
+            cv_.notify_all();
+        }
+
+        void drain() noexcept {
+            submit();
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [&] { return !busy_; });
+        }
+
+        void write_bytes(const char* ptr, arg_type size) noexcept override final {
+            for (size_t left = static_cast<size_t>(size); left; ) {
+                size_t const n = std::min(left, front_.size() - front_len_);
+                memcpy(front_.data() + front_len_, ptr, n);
+                front_len_ += n;
+                ptr += n;
+                left -= n;
+                if (front_len_ == front_.size()) submit();
+            }
+        }
+
+        void read_bytes(char* ptr, arg_type size) noexcept override final {
+            drain();
+            inner_.read(ptr, size);
+        }
+
+    public:
+        static constexpr size_t default_buffer_size = size_t{ 8 } << 20;
+
+        /**
+         * @brief Wraps inner and starts the writer thread.
+         * @param buffer_size Bytes per buffer; two are allocated.
+         * @throws std::invalid_argument if buffer_size is 0 or larger than 1 GiB.
+         */
+        explicit AsyncStream(Stream& inner, size_t buffer_size = default_buffer_size) : inner_(inner) {
+            INVALID_ARGUMENT_IF(buffer_size == 0 || buffer_size > max_chunk_bytes, "AsyncStream: invalid buffer size {}", buffer_size);
+            front_.resize(buffer_size);
+            back_.resize(buffer_size);
+            worker_ = std::thread([this] { run(); });
+        }
+
+        AsyncStream(const AsyncStream&) = delete;
+        AsyncStream& operator=(const AsyncStream&) = delete;
+
+        /**
+         * @brief Waits for pending writes and stops the writer; errors are not thrown here.
+         */
+        ~AsyncStream() {
+            drain();
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            worker_.join();
+        }
+
+        /**
+         * @brief True once a background write, or a read or seek on the inner stream, failed.
+         *
+         * Waits for a write in progress, so the inner stream is not queried concurrently.
+         */
+        bool failed() const noexcept override final {
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [&] { return !busy_; });
+            return failed_ || inner_.failed();
+        }
+
+        /**
+         * @brief Number of times a writer blocked because both buffers were full.
+         */
+        uint64_t stalls() const noexcept {
+            std::lock_guard lock(mutex_);
+            return stalls_;
+        }
+
+        size_t buffer_size() const noexcept { return front_.size(); }
+
+        /**
+         * @brief Waits until all buffered bytes are written, then flushes the inner stream.
+         */
+        void flush() noexcept override final {
+            drain();
+            inner_.flush();
+        }
+
+        /**
+         * @brief Flushes and reports a background failure; the inner stream stays open.
+         * @throws std::domain_error if any background write failed.
+         */
+        void close() override final {
+            flush();
+            DOMAIN_ERROR_IF(failed(), "AsyncStream: background write failed\n");
+        }
+
+        void begin() override final { drain(); inner_.begin(); }
+        void end() override final { drain(); inner_.end(); }
+        bool empty() noexcept override final { drain(); return inner_.empty(); }
+        int64_t tell() noexcept override final { drain(); return inner_.tell(); }
+        bool seek(int64_t offset) noexcept override final { drain(); return inner_.seek(offset); }
+        int64_t write_position() noexcept override final { drain(); return inner_.write_position(); }
+        bool overwrite(int64_t offset, const char* ptr, arg_type size) noexcept override final {
+            drain();
+            return inner_.overwrite(offset, ptr, size);
+        }
+
+        AsyncStream& clear() noexcept override final {
+            drain();
+            {
+                std::lock_guard lock(mutex_);
+                failed_ = false;
+            }
+            inner_.clear();
+            return *this;
+        }
+        AsyncStream& operator=(const Stream& rhs) noexcept override final { return clear() << rhs; }
+        AsyncStream& operator<<(const Stream& rhs) noexcept override final {
+            std::streambuf* buffer = rhs.rdbuf();
+            if (!buffer) return *this;
+            for (;;) {
+                if (front_len_ == front_.size()) submit();
+                std::streamsize const n = buffer->sgetn(front_.data() + front_len_, static_cast<std::streamsize>(front_.size() - front_len_));
+                if (n <= 0) break;
+                front_len_ += static_cast<size_t>(n);
+            }
+            return *this;
+        }
+        std::streambuf* rdbuf() const noexcept override final { return inner_.rdbuf(); }
+        bool is_open() const noexcept override final { return inner_.is_open(); }
+        bool is_file() const noexcept override final { return inner_.is_file(); }
+        void save(const char* name) override final { drain(); inner_.save(name); }
+        void load(const char* name) override final { drain(); inner_.load(name); }
+    };
+
+} // namespace mz
+
+#endif // MZ_ASYNC_STREAM_HEADER_FILE
@@ -0,0 +1,405 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef MZ_BENCH_HEADER_FILE
+#define MZ_BENCH_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "globals.h"
+#include "timer_utils.h"
+#include "alloc_utils.h"
+
+/**
+ * @file zbench.h
+ * @brief Statistical micro-benchmark harness built on TimerT<SteadyClock>.
+ *
+ * This header defines:
+ *   - mz::do_not_optimize(value), mz::clobber_memory(): compiler barriers that keep a
+ *     result alive and force pending stores to memory (DoNotOptimize / ClobberMemory).
+ *   - mz::BenchOptions: warmup, target time per sample, repetitions, outlier threshold,
+ *     filter, JSON output and baseline comparison.
+ *   - mz::BenchResult: per-iteration median, MAD, min, mean, outliers and throughput.
+ *   - mz::Bench: runs benchmarks, parameter and type sweeps, prints a table, writes JSON
+ *     and compares against a saved baseline.
+ *
+ * For each benchmark the body runs for the warmup time, then the iteration count is grown
+ * until one batch takes at least min_time, then `repetitions` batches are timed. Samples
+ * farther than outlier_mads scaled MADs from the median are dropped and the statistics are
+ * recomputed on the rest. A benchmark regresses when its median is more than `threshold`
+ * (relative) above the baseline median and the gap also exceeds three MADs of both runs.
+ *
+ * Needs nothing beyond the standard library; a benchmark is one .cpp file:
+ *   c++ -std=c++20 -O2 -I. benchmarks/error_checks.cpp -o checks
+ *   ./checks --json=base.json
+ *   ./checks --baseline=base.json --threshold=0.05     # exit code 1 on regression
+ *
+ * Usage example:
+ *   int main(int argc, char** argv) {
+ *       mz::Bench bench(argc, argv);
+ *       bench.run("sum 1k", [&] { mz::do_not_optimize(sum(v)); }, { .bytes = 8192 });
+ *       bench.sweep("push_back", { 1 << 10, 1 << 16 }, [](int n) {
+ *           return [n] { mz::Vector<int> v; for (int i = 0; i < n; i++) v.push_back(i); mz::do_not_optimize(v); };
+ *       });
+ *       bench.sweep_types<float, double>("fill", []<typename T>(std::type_identity<T>) {
+ *           return [v = mz::Vector<T>(1024, 1024)]() mutable { v = T(1); mz::clobber_memory(); };
+ *       });
+ *       return bench.finish();
+ *   }
+ */
+
+namespace mz {
+
+    /**
+     * @brief Makes the compiler assume @p value is read, so computing it cannot be elided.
+     */
+    template <typename T>
+    inline void do_not_optimize(T const& value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+    template <typename T>
+    inline void do_not_optimize(T& value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : "+m,r"(value) : : "memory");
+#else
+        static volatile void* sink;
+        sink = &value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+    /**
+     * @brief Forces all pending writes to be treated as visible (a compiler-only barrier).
+     */
+    inline void clobber_memory() noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : : "memory");
+#else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+    struct BenchOptions {
+        double warmup_seconds = 0.05;       // per benchmark, before calibration
+        double min_time = 0.01;             // seconds per timed sample
+        int repetitions = 15;               // timed samples per benchmark
+        int64_t max_iterations = int64_t{ 1 } << 30;
+        double outlier_mads = 3.0;          // drop samples beyond this many scaled MADs
+        std::string filter;                 // run only names containing this
+        std::string json_path;              // write results here on finish()
+        std::string baseline_path;          // compare against this on finish()
+        double threshold = 0.05;            // relative median slowdown counted as a regression
+        bool quiet = false;                 // no table output
+    };
+
+    /**
+     * @brief Optional per-benchmark work counts for throughput.
+     */
+    struct BenchWork {
+        double bytes = 0;                   // processed per iteration
+        double items = 0;
+    };
+
+    struct BenchResult {
+        std::string name;
+        int64_t iterations = 0;             // per sample
+        int samples = 0;                    // kept after outlier rejection
+        int outliers = 0;
+        double median_ns = 0;               // per iteration
+        double mad_ns = 0;                  // median absolute deviation, per iteration
+        double min_ns = 0;
+        double mean_ns = 0;
+        BenchWork work;
+
+        double bytes_per_second() const noexcept { return median_ns > 0 ? work.bytes * 1e9 / median_ns : 0; }
+        double items_per_second() const noexcept { return median_ns > 0 ? work.items * 1e9 / median_ns : 0; }
+    };
+
+    class Bench {
+        BenchOptions options_;
+        std::vector<BenchResult> results_;
+        bool header_printed_ = false;
+
+        static double median_of(std::vector<double> v) {
+            if (v.empty()) return 0;
+            size_t const mid = v.size() / 2;
+            std::nth_element(v.begin(), v.begin() + mid, v.end());
+            double m = v[mid];
+            if (v.size() % 2 == 0) m = (m + *std::max_element(v.begin(), v.begin() + mid)) / 2;
+            return m;
+        }
+
+        static double mad_of(const std::vector<double>& v, double median) {
+            std::vector<double> d(v.size());
+            for (size_t i = 0; i < v.size(); i++) d[i] = std::abs(v[i] - median);
+            return median_of(std::move(d));
+        }
+
+        static std::string escape(std::string_view s) {
+            std::string out;
+            for (char c : s) {
+                if (c == '"' || c == '\\') out += '\\';
+                if (static_cast<unsigned char>(c) >= 0x20) out += c;
+            }
+            return out;
+        }
+
+        template <typename F>
+        static double time_batch(F& body, int64_t n) {
+            SteadyTimer timer;
+            for (int64_t i = 0; i < n; i++) body();
+            timer.stamp();
+            return static_cast<double>(timer.last_ns());
+        }
+
+        void print_result(const BenchResult& r) {
+            if (options_.quiet) return;
+            if (!header_printed_) {
+                mz::print("{:<52} {:>12} {:>8} {:>13} {:>6} {:>12}\n", "benchmark", "ns/iter", "+-MAD%", "iterations", "outl", "throughput");
+                header_printed_ = true;
+            }
+            std::string rate;
+            if (r.work.bytes > 0) rate = std::format("{:.2f} GB/s", r.bytes_per_second() * 1e-9);
+            else if (r.work.items > 0) rate = std::format("{:.2f} M/s", r.items_per_second() * 1e-6);
+            mz::print("{:<52} {:>12.2f} {:>7.2f}% {:>9}x{:<3} {:>6} {:>12}\n", r.name, r.median_ns,
+                r.median_ns > 0 ? 100.0 * r.mad_ns / r.median_ns : 0.0, r.iterations, r.samples, r.outliers, rate);
+        }
+
+        // Reads the files written by save_json: one result object per line
+        static std::vector<BenchResult> load_json(const std::string& path) {
+            std::vector<BenchResult> out;
+            std::ifstream in(path);
+            std::string line;
+            auto field = [](const std::string& l, std::string_view key) -> std::string_view {
+                std::string const k = std::format("\"{}\":", key);
+                size_t p = l.find(k);
+                if (p == std::string::npos) return {};
+                p += k.size();
+                if (l[p] == '"') {
+                    size_t e = p + 1;
+                    while (e < l.size() && l[e] != '"') e += l[e] == '\\' ? 2 : 1;
+                    return std::string_view(l).substr(p + 1, e - p - 1);
+                }
+                size_t const e = l.find_first_of(",}", p);
+                return std::string_view(l).substr(p, e - p);
+            };
+            while (std::getline(in, line)) {
+                std::string_view const name = field(line, "name");
+                if (name.empty()) continue;
+                BenchResult r;
+                for (size_t i = 0; i < name.size(); i++) {
+                    if (name[i] == '\\' && i + 1 < name.size()) i++;
+                    r.name += name[i];
+                }
+                r.median_ns = std::atof(std::string(field(line, "median_ns")).c_str());
+                r.mad_ns = std::atof(std::string(field(line, "mad_ns")).c_str());
+                out.push_back(std::move(r));
+            }
+            return out;
+        }
+
+    public:
+        explicit Bench(BenchOptions options = {}) : options_(std::move(options)) {}
+
+        /**
+         * @brief Options from the command line: --json=path --baseline=path --threshold=x
+         *        --filter=text --repetitions=n --min-time=seconds --warmup=seconds --quiet.
+         */
+        Bench(int argc, char** argv, BenchOptions options = {}) : options_(std::move(options)) {
+            for (int i = 1; i < argc; i++) {
+                std::string_view a = argv[i];
+                auto value = [&](std::string_view key) -> const char* {
+                    return a.starts_with(key) && a.size() > key.size() && a[key.size()] == '=' ? argv[i] + key.size() + 1 : nullptr;
+                };
+                if (auto v = value("--json")) options_.json_path = v;
+                else if (auto v = value("--baseline")) options_.baseline_path = v;
+                else if (auto v = value("--threshold")) options_.threshold = std::atof(v);
+                else if (auto v = value("--filter")) options_.filter = v;
+                else if (auto v = value("--repetitions")) options_.repetitions = (std::max)(1, std::atoi(v));
+                else if (auto v = value("--min-time")) options_.min_time = std::atof(v);
+                else if (auto v = value("--warmup")) options_.warmup_seconds = std::atof(v);
+                else if (a == "--quiet") options_.quiet = true;
+            }
+        }
+
+        BenchOptions& options() noexcept { return options_; }
+        const std::vector<BenchResult>& results() const noexcept { return results_; }
+
+        /**
+         * @brief Benchmarks one iteration of @p body. Skipped (returns nullptr) when the
+         *        name does not match the filter.
+         */
+        template <typename F>
+        const BenchResult* run(std::string name, F&& body, BenchWork work = {}) {
+            if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) return nullptr;
+
+            SteadyTimer warmup;
+            while (warmup.total_seconds() < options_.warmup_seconds) { body(); warmup.stamp(); }
+
+            double const target_ns = options_.min_time * 1e9;
+            int64_t n{ 1 };
+            for (;;) {
+                double const ns = time_batch(body, n);
+                if (ns >= target_ns || n >= options_.max_iterations) break;
+                double const grow = ns > 0 ? std::clamp(1.4 * target_ns / ns, 2.0, 100.0) : 100.0;
+                n = (std::min)(options_.max_iterations, static_cast<int64_t>(static_cast<double>(n) * grow));
+            }
+
+            std::vector<double> samples(static_cast<size_t>(options_.repetitions));
+            for (double& s : samples) s = time_batch(body, n) / static_cast<double>(n);
+
+            double median = median_of(samples);
+            double mad = mad_of(samples, median);
+            double const limit = options_.outlier_mads * 1.4826 * mad;
+            std::vector<double> kept;
+            for (double s : samples) if (mad == 0 || std::abs(s - median) <= limit) kept.push_back(s);
+            median = median_of(kept);
+            mad = mad_of(kept, median);
+
+            BenchResult r;
+            r.name = std::move(name);
+            r.iterations = n;
+            r.samples = static_cast<int>(kept.size());
+            r.outliers = static_cast<int>(samples.size() - kept.size());
+            r.median_ns = median;
+            r.mad_ns = mad;
+            r.min_ns = *std::min_element(kept.begin(), kept.end());
+            for (double s : kept) r.mean_ns += s / static_cast<double>(kept.size());
+            r.work = work;
+            print_result(r);
+            results_.push_back(std::move(r));
+            return &results_.back();
+        }
+
+        /**
+         * @brief Runs "name/p" for each parameter; @p factory(p) does the setup and returns
+         *        the body to time. @p work(p) optionally gives the work per iteration.
+         */
+        template <typename P, typename Factory, typename Work = BenchWork(*)(const P&)>
+        void sweep(std::string_view name, std::initializer_list<P> params, Factory&& factory,
+                   Work&& work = [](const P&) { return BenchWork{}; }) {
+            for (const P& p : params) {
+                auto body = factory(p);
+                run(std::format("{}/{}", name, p), body, work(p));
+            }
+        }
+
+        /**
+         * @brief Runs "name<T>" for each type; @p factory(std::type_identity<T>{}) does the
+         *        setup and returns the body to time.
+         */
+        template <typename... Ts, typename Factory>
+        void sweep_types(std::string_view name, Factory&& factory) {
+            (run(std::format("{}<{}>", name, alloc_stats::type_name<Ts>()), factory(std::type_identity<Ts>{})), ...);
+        }
+
+        /**
+         * @brief All results as JSON, one result object per line.
+         */
+        std::string json() const {
+            std::string out = "{\"benchmarks\":[\n";
+            for (size_t i = 0; i < results_.size(); i++) {
+                const BenchResult& r = results_[i];
+                out += std::format("{{\"name\":\"{}\",\"iterations\":{},\"samples\":{},\"outliers\":{},\"median_ns\":{:.4f},\"mad_ns\":{:.4f},\"min_ns\":{:.4f},\"mean_ns\":{:.4f},\"bytes_per_second\":{:.1f},\"items_per_second\":{:.1f}}}{}\n",
+                    escape(r.name), r.iterations, r.samples, r.outliers, r.median_ns, r.mad_ns, r.min_ns, r.mean_ns,
+                    r.bytes_per_second(), r.items_per_second(), i + 1 < results_.size() ? "," : "");
+            }
+            out += "]}\n";
+            return out;
+        }
+
+        /**
+         * @brief Writes json() to @p path.
+         * @return true on error.
+         */
+        bool save_json(const std::string& path) const {
+            std::ofstream out(path, std::ios::binary);
+            out << json();
+            return !out;
+        }
+
+        /**
+         * @brief Compares the results with a file written by save_json and prints a table.
+         * @return Number of regressions (benchmarks slower than threshold and beyond noise),
+         *         or -1 if the baseline is missing, unreadable or empty.
+         */
+        int compare(const std::string& baseline_path, double threshold) const {
+            std::vector<BenchResult> const base = load_json(baseline_path);
+            if (base.empty()) {
+                mz::print("baseline {}: no results\n", baseline_path);
+                return -1;
+            }
+            int regressions{ 0 };
+            mz::print("\n{:<52} {:>12} {:>12} {:>9}\n", "benchmark", "baseline ns", "current ns", "change");
+            for (const BenchResult& r : results_) {
+                auto it = std::find_if(base.begin(), base.end(), [&](const BenchResult& b) { return b.name == r.name; });
+                if (it == base.end()) continue;
+                double const change = it->median_ns > 0 ? r.median_ns / it->median_ns - 1.0 : 0.0;
+                double const noise = 3.0 * (std::max)(r.mad_ns, it->mad_ns);
+                bool const regressed = change > threshold && r.median_ns - it->median_ns > noise;
+                bool const improved = change < -threshold && it->median_ns - r.median_ns > noise;
+                regressions += regressed;
+                mz::print("{:<52} {:>12.2f} {:>12.2f} {:>+8.1f}% {}\n", r.name, it->median_ns, r.median_ns, 100.0 * change,
+                    regressed ? "REGRESSION" : improved ? "faster" : "");
+            }
+            return regressions;
+        }
+
+        /**
+         * @brief Writes JSON and compares with the baseline as configured.
+         * @return Exit code: 1 when a regression was found, the baseline yielded no results or
+         *         JSON could not be written, else 0.
+         */
+        int finish() const {
+            int code{ 0 };
+            if (!options_.json_path.empty() && save_json(options_.json_path)) {
+                mz::print("cannot write {}\n", options_.json_path);
+                code = 1;
+            }
+            if (!options_.baseline_path.empty() && compare(options_.baseline_path, options_.threshold) != 0) code = 1;
+            return code;
+        }
+    };
+
+} // namespace mz
+
+#endif // MZ_BENCH_HEADER_FILE
@@ -397,15 +397,26 @@ public:
      */
     std::string string(std::integral auto NumBits = 32) const noexcept {
         char Data[64]{};
+        char* End = format_to(Data, NumBits);
+        return std::string{ Data, End };
+    }
+
+    /**
+     * @brief Write the bits (LSB first, at least NumBits of them) to an output iterator.
+     * @return Iterator past the last character written.
+     */
+    template <typename OutputIt>
+    OutputIt format_to(OutputIt Out, std::integral auto NumBits = 32) const noexcept {
         unsigned long long Value = bits;
         size_type Index{ 0 };
         while (Value) {
-            Data[Index++] = '0' + (Value & 1);
+            *Out++ = static_cast<char>('0' + (Value & 1));
             Value >>= 1;
+            ++Index;
         }
         NumBits = NumBits < 64 ? NumBits : 64;
-        while (Index < NumBits) { Data[Index++] = '0'; }
-        return std::string{ Data, size_t(Index) };
+        for (; Index < NumBits; ++Index) { *Out++ = '0'; }
+        return Out;
     }
 
     // --- Friend Operators ---
@@ -462,7 +473,7 @@ public:
     BitsT<T> Pos{ 0 }; ///< Positive bitset.
     BitsT<T> Neg{ 0 }; ///< Negative bitset.
 
-    using value_type = typename BitsT<T>;
+    using value_type = BitsT<T>;
 
     // --- Constructors ---
 
@@ -1016,17 +1027,7 @@ struct std::formatter<BitsT<T>> : std::formatter<int> {
      * @brief Format BitsT<T> to string.
      */
     auto format(BitsT<T> const& B, std::format_context& ctx) const {
-        int Count{ get_count(ctx) };
-        return std::format_to(ctx.out(), "{}", B.string(Count));
-
-        if (NumBits >= 0) {
-            return std::format_to(ctx.out(), "{}", B.string(NumBits));
-        }
-        int Count2 = std::visit_format_arg([&](auto&& v) -> int {
-            if constexpr (std::is_integral_v<std::decay_t<decltype(v)>>) { return static_cast<int>(v); }
-            else throw std::format_error("Invalid format args for graph_state_t");
-            }, ctx.arg(argid));
-        return std::format_to(ctx.out(), "{}", B.string(Count2));
+        return B.format_to(ctx.out(), get_count(ctx));
     }
 };
 
@@ -0,0 +1,224 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_CHECKPOINT_HEADER_FILE
+#define MZ_CHECKPOINT_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "globals.h"
+#include "zstream.h"
+#include "zchecksum.h"
+#include "Vector.h"
+
+/**
+ * @file zcheckpoint.h
+ * @brief Incremental (delta) checkpoints of contiguous Vectors.
+ *
+ * This header defines:
+ *   - mz::DeltaCheckpoint: remembers a hash per page of a Vector's bytes and writes only the
+ *     pages that changed since the previous checkpoint; restore replays a base and its deltas.
+ *
+ * Record layout (each record is bracketed by labels, as in Vector::save3):
+ *   u64 magic ("MZCKBASE" or "MZCKDLTA") | u64 sequence | size_type elements | u32 page bytes
+ *   base:  all element bytes | u32 crc32c(bytes)
+ *   delta: u32 page count | per page: u32 page index, page bytes | u32 crc32c(pages)
+ *
+ * Changed pages are found by comparing XXH64 hashes of each page with those of the last
+ * checkpoint, so no memory protection tricks are needed and any Vector works, whatever its
+ * allocation. A delta that would rewrite more than rebase_fraction of the pages is written
+ * as a new base instead. Sequence numbers must be consecutive from the last base, so a
+ * missing or reordered delta is reported instead of silently restoring a mix of states.
+ *
+ * Usage example:
+ *   mz::DeltaCheckpoint<double> ck;
+ *   mz::FileStream log("state.ck");
+ *   ck.save_base(log, state);
+ *   for (...) { step(state); ck.save_delta(log, state); }
+ *
+ *   mz::DeltaCheckpoint<double> restored;
+ *   mz::FileStream in("state.ck");
+ *   if (restored.restore(in, state)) { ... }     // true on error
+ *   restored.save_delta(out, state);             // the chain continues from the restored state
+ */
+
+namespace mz {
+
+    template <typename T>
+        requires(std::is_trivially_copyable_v<T>)
+    class DeltaCheckpoint {
+        static constexpr uint64_t base_magic = 0x455341424B435A4Dull;  // "MZCKBASE"
+        static constexpr uint64_t delta_magic = 0x41544C444B435A4Dull; // "MZCKDLTA"
+
+        std::vector<uint64_t> hashes_;    // per page of the last checkpointed state
+        size_t page_bytes_;
+        double rebase_fraction_;
+        uint64_t sequence_ = 0;           // of the last record written or applied
+        bool has_base_ = false;
+        size_t dirty_pages_ = 0;          // pages written by the last checkpoint
+
+        static size_t page_count(size_t bytes, size_t page) noexcept { return (bytes + page - 1) / page; }
+
+        void rehash(const char* bytes, size_t length) {
+            hashes_.resize(page_count(length, page_bytes_));
+            for (size_t p = 0; p < hashes_.size(); p++) {
+                hashes_[p] = xxhash64(bytes + p * page_bytes_, std::min(page_bytes_, length - p * page_bytes_));
+            }
+        }
+
+        void write_header(Stream& s, uint64_t magic, size_type elements) noexcept {
+            s << magic << sequence_ << elements << static_cast<uint32_t>(page_bytes_);
+        }
+
+    public:
+        /**
+         * @param page_bytes Granularity of change detection (rounded up to a multiple of 64).
+         * @param rebase_fraction Write a full base once more than this fraction of pages changed.
+         */
+        explicit DeltaCheckpoint(size_t page_bytes = 4096, double rebase_fraction = 0.5) noexcept
+            : page_bytes_((std::max<size_t>(page_bytes, 64) + 63) & ~size_t{ 63 }), rebase_fraction_(rebase_fraction) {}
+
+        size_t page_bytes() const noexcept { return page_bytes_; }
+        uint64_t sequence() const noexcept { return sequence_; }
+
+        // Pages written by the last save (all pages for a base)
+        size_t dirty_pages() const noexcept { return dirty_pages_; }
+        size_t total_pages() const noexcept { return hashes_.size(); }
+
+        /**
+         * @brief Writes the whole Vector and starts a new chain of deltas.
+         */
+        void save_base(Stream& s, const Vector<T>& v, uint64_t Enc = 0) {
+            const char* bytes = reinterpret_cast<const char*>(v.data());
+            size_t const length = sizeof(T) * static_cast<size_t>(v.size());
+            sequence_ = 0;
+            s.write_label(Enc);
+            write_header(s, base_magic, v.size());
+            s.write(v.data(), v.size());
+            s << crc32c(bytes, length);
+            s.write_label(Enc);
+            rehash(bytes, length);
+            has_base_ = true;
+            dirty_pages_ = hashes_.size();
+        }
+
+        /**
+         * @brief Writes the pages changed since the last checkpoint.
+         *
+         * Falls back to save_base when there is no base yet or too many pages changed.
+         * @return Number of pages written.
+         */
+        size_t save_delta(Stream& s, const Vector<T>& v, uint64_t Enc = 0) {
+            const char* bytes = reinterpret_cast<const char*>(v.data());
+            size_t const length = sizeof(T) * static_cast<size_t>(v.size());
+            size_t const pages = page_count(length, page_bytes_);
+
+            std::vector<uint32_t> dirty;
+            std::vector<uint64_t> hashes(pages);
+            for (size_t p = 0; p < pages; p++) {
+                hashes[p] = xxhash64(bytes + p * page_bytes_, std::min(page_bytes_, length - p * page_bytes_));
+                if (p >= hashes_.size() || hashes[p] != hashes_[p]) dirty.push_back(static_cast<uint32_t>(p));
+            }
+            if (!has_base_ || static_cast<double>(dirty.size()) > rebase_fraction_ * static_cast<double>(pages)) {
+                save_base(s, v, Enc);
+                return dirty_pages_;
+            }
+
+            sequence_++;
+            s.write_label(Enc);
+            write_header(s, delta_magic, v.size());
+            s << static_cast<uint32_t>(dirty.size());
+            uint32_t crc{ 0 };
+            for (uint32_t p : dirty) {
+                size_t const offset = p * page_bytes_;
+                size_t const n = std::min(page_bytes_, length - offset);
+                s << p;
+                s.write(bytes + offset, static_cast<int>(n));
+                crc = crc32c(bytes + offset, n, crc);
+            }
+            s << crc;
+            s.write_label(Enc);
+            hashes_.swap(hashes);
+            dirty_pages_ = dirty.size();
+            return dirty_pages_;
+        }
+
+        /**
+         * @brief Applies every record in s to v: a base replaces v, a delta patches its pages.
+         *
+         * Call it on the base stream and then on each delta stream, in order. Afterwards the
+         * checkpointer tracks v, so save_delta continues the chain.
+         * @return true on error (label, checksum or sequence mismatch, or truncated data).
+         */
+        bool restore(Stream& s, Vector<T>& v, uint64_t Enc = 0) {
+            while (!s.empty()) {
+                if (s.read_label(Enc)) return true;
+                uint64_t magic{ 0 }, sequence{ 0 };
+                size_type elements{ -1 };
+                uint32_t page{ 0 };
+                s >> magic >> sequence >> elements >> page;
+                if (elements < 0 || page == 0 || s.failed()) return true;
+                size_t const length = sizeof(T) * static_cast<size_t>(elements);
+                uint32_t crc{ 0 }, stored{ 0 };
+
+                if (magic == base_magic) {
+                    v.resize(elements, false);
+                    s.read(v.data(), elements);
+                    crc = crc32c(v.data(), length);
+                    has_base_ = true;
+                }
+                else if (magic == delta_magic) {
+                    if (!has_base_ || sequence != sequence_ + 1 || page != page_bytes_) return true;
+                    v.resize(elements, true);
+                    char* bytes = reinterpret_cast<char*>(v.data());
+                    uint32_t count{ 0 };
+                    s >> count;
+                    for (uint32_t i = 0; i < count; i++) {
+                        uint32_t p{ UINT32_MAX };
+                        s >> p;
+                        size_t const offset = static_cast<size_t>(p) * page_bytes_;
+                        if (offset >= length) return true;
+                        size_t const n = std::min(page_bytes_, length - offset);
+                        s.read(bytes + offset, static_cast<int>(n));
+                        crc = crc32c(bytes + offset, n, crc);
+                    }
+                }
+                else {
+                    return true;
+                }
+                s >> stored;
+                if (crc != stored || s.failed() || s.read_label(Enc)) return true;
+                page_bytes_ = page;
+                sequence_ = sequence;
+            }
+            rehash(reinterpret_cast<const char*>(v.data()), sizeof(T) * static_cast<size_t>(v.size()));
+            dirty_pages_ = 0;
+            return false;
+        }
+    };
+
+} // namespace mz
+
+#endif // MZ_CHECKPOINT_HEADER_FILE
@@ -0,0 +1,526 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_CHECKSUM_HEADER_FILE
+#define MZ_CHECKSUM_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "globals.h"
+#include "zstream.h"
+#include "zmmap.h"
+
+#if defined(__SSE4_2__) || (defined(_MSC_VER) && defined(__AVX__))
+#include <nmmintrin.h>
+#define MZ_CRC32C_SSE42 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define MZ_CRC32C_ARM 1
+#endif
+
+/**
+ * @file zchecksum.h
+ * @brief Checksums and checksummed block framing for mz::Stream payloads.
+ *
+ * This header defines:
+ *   - mz::crc32c: CRC-32C (Castagnoli) using the SSE4.2 / ARMv8 crc32 instructions (three
+ *     interleaved lanes) when the target enables them, and a slicing-by-8 table otherwise.
+ *   - mz::xxhash64: the XXH64 hash (a faster, non-CRC alternative).
+ *   - mz::ChecksumStream: Stream decorator that frames the byte stream into blocks, each
+ *     carrying a checksum that is verified as the block is read back.
+ *   - mz::verify_file: checks every block of a checksummed file through a read-only mapping.
+ *
+ * Frame layout written to the inner stream:
+ *   "MZCKSUM1" | u32 block size | u32 checksum kind
+ *   per block: u32 length | u64 checksum(payload, seed = block number) | payload
+ *   u32 0 | u64 total payload bytes | u64 checksum(total, seed = block count)
+ *
+ * Seeding with the block number catches reordered or duplicated blocks; the trailer catches
+ * truncation at a block boundary.
+ *
+ * Usage example:
+ *   mz::FileStream file("checkpoint.bin");
+ *   {
+ *       mz::ChecksumStream cs(file);
+ *       vec.save(cs);
+ *   }                                  // destructor writes the last block and the trailer
+ *   auto report = mz::verify_file("checkpoint.bin");
+ *   if (!report.ok) { ... }            // report.bad_block names the first bad block
+ */
+
+namespace mz {
+
+    namespace checksum_detail {
+
+        inline constexpr uint64_t magic = 0x314D55534B435A4Dull; // "MZCKSUM1", written by ChecksumStream
+        inline constexpr size_t max_block_size = size_t{ 1 } << 26;
+
+        inline constexpr uint32_t crc32c_polynomial = 0x82F63B78u; // reflected Castagnoli
+
+        constexpr std::array<std::array<uint32_t, 256>, 8> make_crc32c_tables() noexcept {
+            std::array<std::array<uint32_t, 256>, 8> tables{};
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (crc32c_polynomial & (0u - (crc & 1)));
+                tables[0][i] = crc;
+            }
+            for (uint32_t i = 0; i < 256; i++) {
+                for (size_t t = 1; t < 8; t++) tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xFF];
+            }
+            return tables;
+        }
+
+        inline constexpr auto crc32c_tables = make_crc32c_tables();
+
+        inline uint64_t load64(const uint8_t* p) noexcept { uint64_t v; memcpy(&v, p, 8); return v; }
+        inline uint32_t load32(const uint8_t* p) noexcept { uint32_t v; memcpy(&v, p, 4); return v; }
+        constexpr uint64_t rotl(uint64_t x, int r) noexcept { return (x << r) | (x >> (64 - r)); }
+
+        // a * b modulo the CRC polynomial, in the reflected bit order the CRC register uses
+        constexpr uint32_t multiply_mod(uint32_t a, uint32_t b) noexcept {
+            uint32_t product{ 0 };
+            for (uint32_t m = 1u << 31; m; m >>= 1) {
+                if (a & m) product ^= b;
+                b = (b & 1) ? (b >> 1) ^ crc32c_polynomial : b >> 1;
+            }
+            return product;
+        }
+
+        // x^(8 * bytes) modulo the polynomial: advances a register over that many zero bytes
+        constexpr uint32_t zero_bytes_shift(size_t bytes) noexcept {
+            uint32_t result = 1u << 31, square = 1u << 30;
+            for (size_t e = 8 * bytes; e; e >>= 1) {
+                if (e & 1) result = multiply_mod(square, result);
+                square = multiply_mod(square, square);
+            }
+            return result;
+        }
+
+#if defined(MZ_CRC32C_SSE42)
+        inline uint32_t crc32c_u64(uint32_t crc, uint64_t v) noexcept { return static_cast<uint32_t>(_mm_crc32_u64(crc, v)); }
+        inline uint32_t crc32c_u8(uint32_t crc, uint8_t v) noexcept { return _mm_crc32_u8(crc, v); }
+#elif defined(MZ_CRC32C_ARM)
+        inline uint32_t crc32c_u64(uint32_t crc, uint64_t v) noexcept { return __crc32cd(crc, v); }
+        inline uint32_t crc32c_u8(uint32_t crc, uint8_t v) noexcept { return __crc32cb(crc, v); }
+#endif
+
+        // The crc32 instruction has a 3-cycle latency and 1-cycle throughput, so three
+        // independent lanes keep it busy; lane registers are merged with zero_bytes_shift.
+        inline constexpr size_t crc32c_lane_bytes = 4096;
+        inline constexpr uint32_t crc32c_lane_shift = zero_bytes_shift(crc32c_lane_bytes);
+
+    } // namespace checksum_detail
+
+    /**
+     * @brief CRC-32C of size bytes; pass a previous result as crc to continue it.
+     *
+     * Usage:
+     *   uint32_t crc = mz::crc32c(header, sizeof(header));
+     *   crc = mz::crc32c(payload, n, crc);
+     */
+    inline uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0) noexcept {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        crc = ~crc;
+#if defined(MZ_CRC32C_SSE42) || defined(MZ_CRC32C_ARM)
+        using namespace checksum_detail;
+        for (; size >= 3 * crc32c_lane_bytes; size -= 3 * crc32c_lane_bytes, p += 3 * crc32c_lane_bytes) {
+            uint32_t a = crc, b = 0, c = 0;
+            for (size_t i = 0; i < crc32c_lane_bytes; i += 8) {
+                a = crc32c_u64(a, load64(p + i));
+                b = crc32c_u64(b, load64(p + crc32c_lane_bytes + i));
+                c = crc32c_u64(c, load64(p + 2 * crc32c_lane_bytes + i));
+            }
+            crc = multiply_mod(crc32c_lane_shift, multiply_mod(crc32c_lane_shift, a) ^ b) ^ c;
+        }
+        for (; size >= 8; size -= 8, p += 8) crc = crc32c_u64(crc, load64(p));
+        for (; size; --size) crc = crc32c_u8(crc, *p++);
+#else
+        auto const& t = checksum_detail::crc32c_tables;
+        for (; size >= 8; size -= 8, p += 8) {
+            uint32_t const lo = checksum_detail::load32(p) ^ crc;
+            uint32_t const hi = checksum_detail::load32(p + 4);
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+                ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        }
+        for (; size; --size) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+#endif
+        return ~crc;
+    }
+
+    /**
+     * @brief XXH64 hash of size bytes.
+     */
+    inline uint64_t xxhash64(const void* data, size_t size, uint64_t seed = 0) noexcept {
+        using checksum_detail::rotl;
+        constexpr uint64_t p1 = 11400714785074694791ull, p2 = 14029467366897019727ull;
+        constexpr uint64_t p3 = 1609587929392839161ull, p4 = 9650029242287828579ull, p5 = 2870177450012600261ull;
+        auto round = [](uint64_t acc, uint64_t input) { return rotl(acc + input * p2, 31) * p1; };
+        auto merge = [&](uint64_t acc, uint64_t v) { return (acc ^ round(0, v)) * p1 + p4; };
+
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        const uint8_t* const end = p + size;
+        uint64_t h;
+        if (size >= 32) {
+            uint64_t v1 = seed + p1 + p2, v2 = seed + p2, v3 = seed, v4 = seed - p1;
+            for (; end - p >= 32; p += 32) {
+                v1 = round(v1, checksum_detail::load64(p));
+                v2 = round(v2, checksum_detail::load64(p + 8));
+                v3 = round(v3, checksum_detail::load64(p + 16));
+                v4 = round(v4, checksum_detail::load64(p + 24));
+            }
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = merge(merge(merge(merge(h, v1), v2), v3), v4);
+        }
+        else {
+            h = seed + p5;
+        }
+        h += size;
+        for (; end - p >= 8; p += 8) h = rotl(h ^ round(0, checksum_detail::load64(p)), 27) * p1 + p4;
+        if (end - p >= 4) {
+            h = rotl(h ^ (checksum_detail::load32(p) * p1), 23) * p2 + p3;
+            p += 4;
+        }
+        for (; p < end; ++p) h = rotl(h ^ (*p * p5), 11) * p1;
+        h ^= h >> 33;
+        h *= p2;
+        h ^= h >> 29;
+        h *= p3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    /**
+     * @brief Checksum used by a ChecksumStream frame.
+     */
+    enum class ChecksumKind : uint8_t { crc32c, xxhash64 };
+
+    /**
+     * @brief Checksum of a block under the given kind, seeded with its block number.
+     */
+    inline uint64_t block_checksum(ChecksumKind kind, const void* data, size_t size, uint64_t block) noexcept {
+        return kind == ChecksumKind::crc32c ? crc32c(data, size, static_cast<uint32_t>(block)) : xxhash64(data, size, block);
+    }
+
+    /**
+     * @brief Stream decorator that checksums fixed-size blocks and verifies them on read.
+     *
+     * The first write starts a frame and the first read parses one. close() and the
+     * destructor finish a frame being written; the inner stream stays open. A checksum
+     * mismatch, a truncated frame or reading past the end sets failed() and yields zero
+     * bytes from then on, so load3-style callers can check failed() after loading.
+     */
+    class ChecksumStream final : public Stream {
+        static constexpr uint64_t header_magic = checksum_detail::magic;
+        static constexpr size_t max_block_size = checksum_detail::max_block_size;
+
+        enum class Mode : uint8_t { idle, write, read };
+
+        Stream& inner_;
+        size_t block_size_;
+        ChecksumKind kind_;
+        Mode mode_ = Mode::idle;
+        bool failed_ = false;
+        bool at_end_ = false;
+        std::vector<char> buffer_;
+        size_t buffer_pos_ = 0;                  // read cursor within buffer_
+        size_t buffer_len_ = 0;                  // bytes buffered (write) or decoded (read)
+        uint64_t blocks_ = 0;
+        uint64_t total_ = 0;
+
+        void reset() noexcept {
+            mode_ = Mode::idle;
+            failed_ = at_end_ = false;
+            buffer_pos_ = buffer_len_ = 0;
+            blocks_ = total_ = 0;
+        }
+
+        void write_block() noexcept {
+            if (!buffer_len_) return;
+            uint32_t const length = static_cast<uint32_t>(buffer_len_);
+            uint64_t const sum = block_checksum(kind_, buffer_.data(), buffer_len_, blocks_++);
+            inner_.write(length);
+            inner_.write(sum);
+            inner_.write(buffer_.data(), static_cast<int>(buffer_len_));
+            total_ += buffer_len_;
+            buffer_len_ = 0;
+        }
+
+        void finish() noexcept {
+            if (mode_ != Mode::write) return;
+            write_block();
+            inner_.write(uint32_t{ 0 });
+            inner_.write(total_);
+            inner_.write(block_checksum(kind_, &total_, sizeof(total_), blocks_));
+            inner_.flush();
+            mode_ = Mode::idle;
+        }
+
+        void write_bytes(const char* ptr, arg_type size) noexcept override final {
+            if (mode_ == Mode::read) { failed_ = true; return; }
+            if (mode_ == Mode::idle) {
+                reset();
+                mode_ = Mode::write;
+                buffer_.resize(block_size_);
+                inner_.write(header_magic);
+                inner_.write(static_cast<uint32_t>(block_size_));
+                inner_.write(static_cast<uint32_t>(kind_));
+            }
+            for (size_t left = static_cast<size_t>(size); left; ) {
+                size_t const n = std::min(left, block_size_ - buffer_len_);
+                memcpy(buffer_.data() + buffer_len_, ptr, n);
+                buffer_len_ += n;
+                ptr += n;
+                left -= n;
+                if (buffer_len_ == block_size_) write_block();
+            }
+        }
+
+        void start_read() noexcept {
+            reset();
+            mode_ = Mode::read;
+            uint64_t magic{ 0 };
+            uint32_t block_size{ 0 }, kind{ UINT32_MAX };
+            inner_.read(magic);
+            inner_.read(block_size);
+            inner_.read(kind);
+            if (magic != header_magic || block_size == 0 || block_size > max_block_size || kind > uint32_t(ChecksumKind::xxhash64)) {
+                failed_ = at_end_ = true;
+                return;
+            }
+            block_size_ = block_size;
+            kind_ = static_cast<ChecksumKind>(kind);
+            buffer_.resize(block_size_);
+        }
+
+        // Reads and verifies the next block; false at the end of the frame or on error
+        bool fill() noexcept {
+            buffer_pos_ = buffer_len_ = 0;
+            if (at_end_) return false;
+            uint32_t length{ UINT32_MAX }; // stays invalid if the inner stream is exhausted
+            uint64_t sum{ 0 };
+            inner_.read(length);
+            inner_.read(sum);
+            if (length == 0) {
+                uint64_t trailer_sum{ 0 };
+                inner_.read(trailer_sum);
+                at_end_ = true;
+                failed_ = failed_ || sum != total_ || trailer_sum != block_checksum(kind_, &total_, sizeof(total_), blocks_);
+                return false;
+            }
+            if (length > block_size_) {
+                failed_ = at_end_ = true;
+                return false;
+            }
+            inner_.read(buffer_.data(), static_cast<int>(length));
+            if (sum != block_checksum(kind_, buffer_.data(), length, blocks_++)) {
+                failed_ = at_end_ = true;
+                return false;
+            }
+            total_ += length;
+            buffer_len_ = length;
+            return true;
+        }
+
+        void read_bytes(char* ptr, arg_type size) noexcept override final {
+            if (mode_ == Mode::idle) start_read();
+            size_t left = static_cast<size_t>(size);
+            while (left && mode_ == Mode::read && (buffer_pos_ < buffer_len_ || fill())) {
+                size_t const n = std::min(left, buffer_len_ - buffer_pos_);
+                memcpy(ptr, buffer_.data() + buffer_pos_, n);
+                buffer_pos_ += n;
+                ptr += n;
+                left -= n;
+            }
+            if (left) {
+                memset(ptr, 0, left);
+                failed_ = true;
+            }
+        }
+
+    public:
+        static constexpr size_t default_block_size = size_t{ 1 } << 20;
+
+        /**
+         * @brief Wraps inner; the decorator does not own it.
+         * @param kind Checksum for writing (readers use the frame's).
+         * @param block_size Payload bytes per checksummed block for writing.
+         * @throws std::invalid_argument if block_size is 0 or larger than 64 MiB.
+         */
+        explicit ChecksumStream(Stream& inner, ChecksumKind kind = ChecksumKind::crc32c, size_t block_size = default_block_size)
+            : inner_(inner), block_size_(block_size), kind_(kind) {
+            INVALID_ARGUMENT_IF(block_size == 0 || block_size > max_block_size, "ChecksumStream: invalid block size {}", block_size);
+        }
+
+        ChecksumStream(const ChecksumStream&) = delete;
+        ~ChecksumStream() { finish(); }
+
+        /**
+         * @brief True after a checksum mismatch, a truncated frame, a misuse of the stream mode
+         * or a failure of the inner stream.
+         */
+        bool failed() const noexcept override final { return failed_ || inner_.failed(); }
+
+        /**
+         * @brief Reads the rest of the frame and reports whether every block and the trailer verified.
+         */
+        bool verify() noexcept {
+            if (mode_ == Mode::idle) start_read();
+            if (mode_ != Mode::read) return false;
+            while (fill()) {}
+            buffer_pos_ = buffer_len_;
+            return !failed_;
+        }
+
+        /**
+         * @brief Writes the buffered partial block (blocks may be shorter than block_size).
+         */
+        void flush() noexcept override final {
+            if (mode_ == Mode::write) write_block();
+            inner_.flush();
+        }
+
+        void close() override final { finish(); reset(); }
+
+        /**
+         * @brief Finishes a frame being written and rewinds the inner stream for reading.
+         */
+        void begin() override final {
+            finish();
+            reset();
+            inner_.begin();
+        }
+
+        void end() override final {
+            if (mode_ == Mode::idle) start_read();
+            if (mode_ == Mode::read) verify();
+        }
+
+        bool empty() noexcept override final {
+            if (mode_ == Mode::write) return total_ + buffer_len_ == 0;
+            if (mode_ == Mode::idle) return inner_.empty();
+            return buffer_pos_ == buffer_len_ && !fill();
+        }
+
+        int64_t tell() noexcept override final {
+            if (mode_ == Mode::write) return static_cast<int64_t>(total_ + buffer_len_);
+            if (mode_ == Mode::read) return static_cast<int64_t>(total_ - buffer_len_ + buffer_pos_);
+            return 0;
+        }
+
+        ChecksumStream& clear() noexcept override final {
+            reset();
+            inner_.clear();
+            return *this;
+        }
+        ChecksumStream& operator=(const Stream& rhs) noexcept override final { return clear() << rhs; }
+        ChecksumStream& operator<<(const Stream& rhs) noexcept override final {
+            std::streambuf* buffer = rhs.rdbuf();
+            if (!buffer) return *this;
+            std::vector<char> chunk(std::min(block_size_, size_t{ 1 } << 16));
+            for (std::streamsize n; (n = buffer->sgetn(chunk.data(), static_cast<std::streamsize>(chunk.size()))) > 0; ) {
+                write_bytes(chunk.data(), static_cast<arg_type>(n));
+            }
+            return *this;
+        }
+        std::streambuf* rdbuf() const noexcept override final { return inner_.rdbuf(); }
+        bool is_open() const noexcept override final { return inner_.is_open(); }
+        bool is_file() const noexcept override final { return inner_.is_file(); }
+        void save(const char* name) override final { finish(); inner_.save(name); }
+        void load(const char* name) override final { inner_.load(name); }
+    };
+
+    /**
+     * @brief Result of verify_file.
+     */
+    struct ChecksumReport {
+        bool ok = false;
+        uint64_t blocks = 0;                     // blocks that verified
+        uint64_t bytes = 0;                      // payload bytes that verified
+        int64_t bad_block = -1;                  // first failing block, -1 if none
+        std::string error;
+    };
+
+    /**
+     * @brief Verifies a ChecksumStream file in place through a read-only mapping.
+     *
+     * Blocks are checksummed directly from the page cache without copying.
+     * @throws std::domain_error if the file cannot be opened or mapped.
+     *
+     * Usage:
+     *   if (auto report = mz::verify_file("checkpoint.bin"); !report.ok) print("{}\n", report.error);
+     */
+    inline ChecksumReport verify_file(std::string name) {
+        MmapStream file(std::move(name));
+        file.advise(MmapAdvice::sequential);
+        const char* const data = file.bytes().data();
+        size_t const size = file.size();
+        ChecksumReport report;
+        size_t pos{ 0 };
+        auto take = [&](auto& value) {
+            if (size - pos < sizeof(value)) return false;
+            memcpy(&value, data + pos, sizeof(value));
+            pos += sizeof(value);
+            return true;
+        };
+
+        uint64_t magic{ 0 };
+        uint32_t block_size{ 0 }, kind{ 0 };
+        if (!take(magic) || !take(block_size) || !take(kind) || magic != checksum_detail::magic || kind > uint32_t(ChecksumKind::xxhash64)) {
+            report.error = "not a checksummed frame";
+            return report;
+        }
+        auto const checksum = static_cast<ChecksumKind>(kind);
+        for (;;) {
+            uint32_t length{ 0 };
+            uint64_t sum{ 0 };
+            if (!take(length) || !take(sum)) {
+                report.error = "truncated before the trailer";
+                report.bad_block = static_cast<int64_t>(report.blocks);
+                return report;
+            }
+            if (length == 0) {
+                uint64_t trailer_sum{ 0 };
+                report.ok = take(trailer_sum) && sum == report.bytes
+                    && trailer_sum == block_checksum(checksum, &report.bytes, sizeof(report.bytes), report.blocks);
+                if (!report.ok) report.error = "trailer mismatch";
+                return report;
+            }
+            if (length > block_size || size - pos < length
+                || sum != block_checksum(checksum, data + pos, length, report.blocks)) {
+                report.error = std::format("block {} is corrupt", report.blocks);
+                report.bad_block = static_cast<int64_t>(report.blocks);
+                return report;
+            }
+            pos += length;
+            report.bytes += length;
+            report.blocks++;
+        }
+    }
+
+} // namespace mz
+
+#endif // MZ_CHECKSUM_HEADER_FILE
@@ -0,0 +1,338 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_COLUMNAR_HEADER_FILE
+#define MZ_COLUMNAR_HEADER_FILE
+#pragma once
+
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "globals.h"
+#include "zstream.h"
+#include "zencoding.h"
+#include "zcompress.h"
+#include "Vector.h"
+
+/**
+ * @file zcolumnar.h
+ * @brief Columnar (structure-of-arrays) save/load for Vectors of records.
+ *
+ * This header defines:
+ *   - mz::field / mz::Field: a named pointer to a record member.
+ *   - mz::ColumnarRecord: records that list their fields in `static constexpr auto fields`.
+ *   - mz::ColumnarOptions: integer encoding and LZ compression applied per column.
+ *   - mz::save_columns / mz::load_columns: whole-record columnar round trip.
+ *   - mz::load_column: loads one field into a Vector<FieldT> and skips the other columns.
+ *
+ * Each field becomes one contiguous column, so a column of similar values delta-encodes
+ * (integral fields, see zencoding.h) and compresses far better than interleaved rows,
+ * and a reader interested in one field never decodes the others (with a seekable stream
+ * it does not read them either). Field types must be trivially copyable.
+ *
+ * Layout: label | "MZCOLMN1" | size_type rows | u32 columns
+ *         | per column: u32 name length, name, u32 element size, u8 encoding, u8 compressed,
+ *           u64 encoded bytes, u64 stored bytes
+ *         | column payloads in the same order | label
+ *
+ * Loading matches columns by name: fields missing from the file keep the values already in
+ * `records` (rows beyond its old size start value-initialized) and unknown columns are
+ * skipped, so records can gain fields over time.
+ *
+ * Usage example:
+ *   struct Particle {
+ *       double x, y;
+ *       int cell;
+ *       static constexpr auto fields = std::make_tuple(
+ *           mz::field("x", &Particle::x), mz::field("y", &Particle::y), mz::field("cell", &Particle::cell));
+ *   };
+ *   mz::save_columns(fs, particles, { .integers = mz::IntEncoding::delta, .compress = true });
+ *   mz::Vector<int> cells;
+ *   if (mz::load_column<&Particle::cell>(fs, cells)) { ... }   // true on error
+ */
+
+namespace mz {
+
+    /**
+     * @brief Named member pointer used in a record's field list.
+     */
+    template <typename Class, typename T>
+    struct Field {
+        using class_type = Class;
+        using value_type = T;
+        std::string_view name;
+        T Class::* member;
+    };
+
+    template <typename Class, typename T>
+    constexpr Field<Class, T> field(std::string_view name, T Class::* member) noexcept { return { name, member }; }
+
+    /**
+     * @brief Record type with a tuple of mz::field entries named `fields`.
+     */
+    template <typename R>
+    concept ColumnarRecord = requires { std::tuple_size<std::remove_cvref_t<decltype(R::fields)>>::value; };
+
+    /**
+     * @brief Column encodings applied by save_columns.
+     */
+    struct ColumnarOptions {
+        IntEncoding integers = IntEncoding::fixed;   // for integral fields other than bool
+        bool compress = false;                       // LZ on top of the encoding, kept only if smaller
+    };
+
+    namespace columnar_detail {
+
+        inline constexpr uint64_t magic = 0x314E4D4C4F435A4Dull; // "MZCOLMN1"
+
+        struct ColumnHeader {
+            std::string name;
+            uint32_t element_size = 0;
+            uint8_t encoding = 0;
+            uint8_t compressed = 0;
+            uint64_t encoded_bytes = 0;
+            uint64_t stored_bytes = 0;
+        };
+
+        template <typename T>
+        constexpr IntEncoding encoding_for(IntEncoding requested) noexcept {
+            if constexpr (std::integral<T> && !std::same_as<T, bool>) {
+                return requested == IntEncoding::stream_vbyte && sizeof(T) != 4 ? IntEncoding::delta : requested;
+            }
+            else {
+                return IntEncoding::fixed;
+            }
+        }
+
+        // Encodes one column into out; fills the sizes and flags of header
+        template <typename T>
+        void encode(const T* values, size_type rows, const ColumnarOptions& options, ColumnHeader& header, Vector<char>& out) noexcept {
+            IntEncoding const encoding = encoding_for<T>(options.integers);
+            Vector<char> encoded;
+            if constexpr (std::integral<T> && !std::same_as<T, bool>) {
+                encoded.resize(static_cast<size_type>(encoding::max_bytes<T>(rows, encoding)), false);
+                encoded.resize(static_cast<size_type>(encoding::encode(values, rows, encoding, reinterpret_cast<uint8_t*>(encoded.data()))), true);
+            }
+            else {
+                encoded.resize(static_cast<size_type>(sizeof(T) * rows), false);
+                memcpy(encoded.data(), values, sizeof(T) * rows);
+            }
+            header.element_size = sizeof(T);
+            header.encoding = static_cast<uint8_t>(encoding);
+            header.encoded_bytes = static_cast<uint64_t>(encoded.size());
+            header.compressed = 0;
+            if (options.compress) {
+                out.resize(static_cast<size_type>(lz::max_compressed_size(encoded.size())), false);
+                out.resize(static_cast<size_type>(lz::compress(encoded.data(), encoded.size(), out.data())), true);
+                header.compressed = out.size() < encoded.size();
+            }
+            if (!header.compressed) out = std::move(encoded);
+            header.stored_bytes = static_cast<uint64_t>(out.size());
+        }
+
+        // Decodes a stored column of rows values; false if it is corrupt or of another type
+        template <typename T>
+        bool decode(const ColumnHeader& header, const Vector<char>& stored, size_type rows, T* values) noexcept {
+            if (header.element_size != sizeof(T) || header.encoding > static_cast<uint8_t>(IntEncoding::stream_vbyte)) return false;
+            Vector<char> expanded;
+            const char* bytes = stored.data();
+            if (!header.compressed && header.encoded_bytes != static_cast<uint64_t>(stored.size())) return false;
+            if (header.compressed) {
+                if (header.encoded_bytes > static_cast<uint64_t>(INT_MAX)) return false;
+                expanded.resize(static_cast<size_type>(header.encoded_bytes), false);
+                if (!lz::decompress(stored.data(), stored.size(), expanded.data(), expanded.size())) return false;
+                bytes = expanded.data();
+            }
+            auto const encoding = static_cast<IntEncoding>(header.encoding);
+            if constexpr (std::integral<T> && !std::same_as<T, bool>) {
+                return encoding::decode(reinterpret_cast<const uint8_t*>(bytes), header.encoded_bytes, encoding, values, rows);
+            }
+            else {
+                if (encoding != IntEncoding::fixed || header.encoded_bytes != sizeof(T) * static_cast<uint64_t>(rows)) return false;
+                memcpy(values, bytes, sizeof(T) * rows);
+                return true;
+            }
+        }
+
+        inline bool read_header(Stream& s, size_type& rows, std::vector<ColumnHeader>& columns) noexcept {
+            uint64_t tag{ 0 };
+            uint32_t count{ 0 };
+            rows = -1;
+            s >> tag >> rows >> count;
+            if (tag != magic || rows < 0 || count > (1u << 16)) return false;
+            columns.resize(count);
+            for (auto& column : columns) {
+                uint32_t length{ 0 };
+                s >> length;
+                if (length > (1u << 16)) return false;
+                column.name.resize(length);
+                s.read(column.name.data(), static_cast<int>(length));
+                s >> column.element_size >> column.encoding >> column.compressed >> column.encoded_bytes >> column.stored_bytes;
+                if (column.stored_bytes > static_cast<uint64_t>(INT_MAX)) return false;
+            }
+            return true;
+        }
+
+        inline bool read_stored(Stream& s, const ColumnHeader& column, Vector<char>& stored) noexcept {
+            stored.resize(static_cast<size_type>(column.stored_bytes), false);
+            s.read(stored.data(), stored.size());
+            return !s.failed();
+        }
+
+        // Moves past a column without decoding it, seeking when the stream allows
+        inline void skip(Stream& s, uint64_t bytes) noexcept {
+            int64_t const here = s.tell();
+            if (here >= 0 && s.seek(here + static_cast<int64_t>(bytes))) return;
+            char discard[1 << 12];
+            for (; bytes; ) {
+                int const n = static_cast<int>(std::min<uint64_t>(bytes, sizeof(discard)));
+                s.read(discard, n);
+                bytes -= static_cast<uint64_t>(n);
+            }
+        }
+
+        template <typename M>
+        struct member_traits;
+
+        template <typename Class, typename T>
+        struct member_traits<T Class::*> {
+            using class_type = Class;
+            using value_type = T;
+        };
+
+        template <typename R, typename Visit>
+        constexpr void for_each_field(Visit&& visit) {
+            std::apply([&](auto const&... fields) { (visit(fields), ...); }, R::fields);
+        }
+
+    } // namespace columnar_detail
+
+    /**
+     * @brief Saves records column by column.
+     */
+    template <ColumnarRecord R>
+    void save_columns(Stream& s, const Vector<R>& records, const ColumnarOptions& options = {}, uint64_t Enc = 0) noexcept {
+        using namespace columnar_detail;
+        size_type const rows = records.size();
+        std::vector<ColumnHeader> headers;
+        std::vector<Vector<char>> payloads;
+        for_each_field<R>([&](auto const& f) {
+            using T = typename std::remove_cvref_t<decltype(f)>::value_type;
+            static_assert(std::is_trivially_copyable_v<T>, "columnar fields must be trivially copyable");
+            Vector<T> column;
+            column.resize(rows, false);
+            for (size_type i = 0; i < rows; i++) column[i] = records[i].*(f.member);
+            headers.emplace_back();
+            headers.back().name = f.name;
+            payloads.emplace_back();
+            encode(column.data(), rows, options, headers.back(), payloads.back());
+        });
+
+        s.write_label(Enc);
+        s << magic << rows << static_cast<uint32_t>(headers.size());
+        for (auto const& h : headers) {
+            s << static_cast<uint32_t>(h.name.size());
+            s.write(h.name.data(), static_cast<int>(h.name.size()));
+            s << h.element_size << h.encoding << h.compressed << h.encoded_bytes << h.stored_bytes;
+        }
+        for (auto const& payload : payloads) s.write(payload.data(), payload.size());
+        s.write_label(Enc);
+    }
+
+    /**
+     * @brief Loads records saved by save_columns, matching columns to fields by name.
+     * @return true on error (label mismatch, corrupt column or element size mismatch).
+     */
+    template <ColumnarRecord R>
+    bool load_columns(Stream& s, Vector<R>& records, uint64_t Enc = 0) noexcept {
+        using namespace columnar_detail;
+        if (s.read_label(Enc)) return true;
+        size_type rows{ 0 };
+        std::vector<ColumnHeader> columns;
+        if (!read_header(s, rows, columns)) return true;
+        size_type const kept = std::min(records.size(), rows);
+        records.resize(rows, true);
+        for (size_type i = kept; i < rows; i++) records[i] = R{};
+
+        bool failed = false;
+        Vector<char> stored;
+        for (auto const& column : columns) {
+            if (!read_stored(s, column, stored)) return true;
+            for_each_field<R>([&](auto const& f) {
+                using T = typename std::remove_cvref_t<decltype(f)>::value_type;
+                if (failed || f.name != column.name) return;
+                Vector<T> values;
+                values.resize(rows, false);
+                if (!decode(column, stored, rows, values.data())) { failed = true; return; }
+                for (size_type i = 0; i < rows; i++) records[i].*(f.member) = values[i];
+            });
+            if (failed) return true;
+        }
+        return s.read_label(Enc);
+    }
+
+    /**
+     * @brief Loads the column called name into out and skips the others.
+     * @return true on error or if the column is missing.
+     */
+    template <typename FieldT>
+    bool load_column(Stream& s, std::string_view name, Vector<FieldT>& out, uint64_t Enc = 0) noexcept {
+        using namespace columnar_detail;
+        if (s.read_label(Enc)) return true;
+        size_type rows{ 0 };
+        std::vector<ColumnHeader> columns;
+        if (!read_header(s, rows, columns)) return true;
+
+        bool found = false;
+        Vector<char> stored;
+        for (auto const& column : columns) {
+            if (found || column.name != name) { skip(s, column.stored_bytes); continue; }
+            if (!read_stored(s, column, stored)) return true;
+            out.resize(rows, false);
+            if (!decode(column, stored, rows, out.data())) return true;
+            found = true;
+        }
+        return s.read_label(Enc) || !found;
+    }
+
+    /**
+     * @brief Loads the column of a record member, e.g. load_column<&Particle::cell>(s, cells).
+     */
+    template <auto Member, typename FieldT>
+    bool load_column(Stream& s, Vector<FieldT>& out, uint64_t Enc = 0) noexcept {
+        using R = typename columnar_detail::member_traits<decltype(Member)>::class_type;
+        static_assert(ColumnarRecord<R>, "the member's class has no field list");
+        static_assert(std::same_as<typename columnar_detail::member_traits<decltype(Member)>::value_type, FieldT>, "output element type differs from the member type");
+        std::string_view name{};
+        columnar_detail::for_each_field<R>([&](auto const& f) {
+            if constexpr (std::same_as<decltype(f.member), decltype(Member)>) {
+                if (f.member == Member) name = f.name;
+            }
+        });
+        return name.empty() || load_column(s, name, out, Enc);
+    }
+
+} // namespace mz
+
+#endif // MZ_COLUMNAR_HEADER_FILE
@@ -0,0 +1,570 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_COMPRESS_HEADER_FILE
+#define MZ_COMPRESS_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <vector>
+#include "globals.h"
+#include "zstream.h"
+#include "thread_utils.h"
+
+/**
+ * @file zcompress.h
+ * @brief Fast in-library LZ block codec and a block-compressing Stream decorator.
+ *
+ * This header defines:
+ *   - mz::lz::compress / mz::lz::decompress: an LZ4-style byte codec (greedy hash-chain
+ *     free matcher, 64 KiB window, literal/match length tokens). No external dependency.
+ *   - mz::CompressedStream: wraps any Stream, splits the byte stream into fixed-size blocks,
+ *     compresses/decompresses batches of blocks on a ThreadPool and keeps a block index
+ *     so a reader can seek by uncompressed offset.
+ *
+ * Frame layout written to the inner stream:
+ *   "MZLZBLK1" | u32 block size
+ *   per block: u32 raw length | u32 stored length | payload (stored raw if it did not shrink)
+ *   u32 0 | u32 0                                  (end of blocks)
+ *   u32 block count | u64 block offsets...         (relative to the frame start)
+ *   u64 raw size | u64 index offset | "MZLZINDX"
+ *
+ * Sequential reads need nothing from the inner stream beyond read_bytes. Seeking needs
+ * an inner stream with tell/seek (FileStream, StringStream, MmapStream) and the frame
+ * to be the last thing in it, since the index is found from the end.
+ *
+ * Usage example:
+ *   mz::FileStream file("checkpoint.lz");
+ *   {
+ *       mz::CompressedStream zs(file);
+ *       vec.save(zs);
+ *   }                                  // destructor writes the last block and the index
+ *   file.begin();
+ *   mz::CompressedStream zs(file);
+ *   vec.load(zs);
+ */
+
+namespace mz {
+
+    namespace lz {
+
+        inline constexpr size_t min_match = 4;
+        inline constexpr size_t last_literals = 5;   // the block always ends with literals
+        inline constexpr size_t match_guard = 12;    // no match starts in the last 12 bytes
+        inline constexpr size_t max_offset = 65535;
+        inline constexpr int hash_bits = 13;
+
+        /**
+         * @brief Worst-case compressed size of size input bytes.
+         */
+        constexpr size_t max_compressed_size(size_t size) noexcept { return size + size / 255 + 16; }
+
+        namespace detail {
+
+            inline uint32_t load32(const uint8_t* p) noexcept { uint32_t v; memcpy(&v, p, 4); return v; }
+            inline uint32_t hash(uint32_t v) noexcept { return (v * 2654435761u) >> (32 - hash_bits); }
+
+            inline uint8_t* put_length(uint8_t* op, size_t length) noexcept {
+                for (; length >= 255; length -= 255) *op++ = 255;
+                *op++ = static_cast<uint8_t>(length);
+                return op;
+            }
+
+            inline const uint8_t* get_length(const uint8_t* ip, const uint8_t* end, size_t& length) noexcept {
+                uint8_t byte{ 255 };
+                while (byte == 255) {
+                    if (ip >= end) return nullptr;
+                    byte = *ip++;
+                    length += byte;
+                }
+                return ip;
+            }
+
+            inline uint8_t* put_sequence(uint8_t* op, const uint8_t* literals, size_t literal_length) noexcept {
+                uint8_t* token = op++;
+                *token = static_cast<uint8_t>(std::min<size_t>(literal_length, 15) << 4);
+                if (literal_length >= 15) op = put_length(op, literal_length - 15);
+                memcpy(op, literals, literal_length);
+                return op + literal_length;
+            }
+
+        } // namespace detail
+
+        /**
+         * @brief Compresses size bytes into destination (at least max_compressed_size(size) bytes).
+         * @return Number of bytes written.
+         */
+        inline size_t compress(const char* source, size_t size, char* destination) noexcept {
+            const uint8_t* const src = reinterpret_cast<const uint8_t*>(source);
+            uint8_t* op = reinterpret_cast<uint8_t*>(destination);
+            const uint8_t* anchor = src;
+
+            if (size > match_guard) {
+                uint32_t table[size_t{ 1 } << hash_bits] = {};
+                const uint8_t* const match_limit = src + size - match_guard;
+                const uint8_t* const extend_limit = src + size - last_literals;
+                const uint8_t* ip = src + 1;
+
+                while (ip < match_limit) {
+                    uint32_t const sequence = detail::load32(ip);
+                    uint32_t& slot = table[detail::hash(sequence)];
+                    const uint8_t* ref = src + slot;
+                    slot = static_cast<uint32_t>(ip - src);
+                    if (ref >= ip || static_cast<size_t>(ip - ref) > max_offset || detail::load32(ref) != sequence) {
+                        ip += 1 + ((ip - anchor) >> 6); // skip faster through incompressible data
+                        continue;
+                    }
+                    while (ip > anchor && ref > src && ip[-1] == ref[-1]) { --ip; --ref; }
+                    const uint8_t* match_end = ip + min_match;
+                    const uint8_t* ref_end = ref + min_match;
+                    while (match_end < extend_limit && *match_end == *ref_end) { ++match_end; ++ref_end; }
+
+                    uint8_t* token = op;
+                    op = detail::put_sequence(op, anchor, static_cast<size_t>(ip - anchor));
+                    size_t const offset = static_cast<size_t>(ip - ref);
+                    *op++ = static_cast<uint8_t>(offset);
+                    *op++ = static_cast<uint8_t>(offset >> 8);
+                    size_t const match_length = static_cast<size_t>(match_end - ip) - min_match;
+                    *token |= static_cast<uint8_t>(std::min<size_t>(match_length, 15));
+                    if (match_length >= 15) op = detail::put_length(op, match_length - 15);
+
+                    if (match_end - 2 > src) table[detail::hash(detail::load32(match_end - 2))] = static_cast<uint32_t>(match_end - 2 - src);
+                    ip = anchor = match_end;
+                }
+            }
+            op = detail::put_sequence(op, anchor, static_cast<size_t>(src + size - anchor));
+            return static_cast<size_t>(op - reinterpret_cast<uint8_t*>(destination));
+        }
+
+        /**
+         * @brief Decompresses exactly raw_size bytes; every read and write is bounds checked.
+         * @return false if the input is malformed or does not decode to raw_size bytes.
+         */
+        inline bool decompress(const char* source, size_t size, char* destination, size_t raw_size) noexcept {
+            const uint8_t* ip = reinterpret_cast<const uint8_t*>(source);
+            const uint8_t* const end = ip + size;
+            uint8_t* const out = reinterpret_cast<uint8_t*>(destination);
+            uint8_t* op = out;
+            uint8_t* const out_end = out + raw_size;
+
+            while (ip < end) {
+                uint8_t const token = *ip++;
+                size_t literal_length = token >> 4;
+                if (literal_length == 15 && !(ip = detail::get_length(ip, end, literal_length))) return false;
+                if (literal_length > static_cast<size_t>(end - ip) || literal_length > static_cast<size_t>(out_end - op)) return false;
+                memcpy(op, ip, literal_length);
+                op += literal_length;
+                ip += literal_length;
+                if (ip == end) break; // last sequence has no match
+
+                if (end - ip < 2) return false;
+                size_t const offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+                ip += 2;
+                size_t match_length = token & 15;
+                if (match_length == 15 && !(ip = detail::get_length(ip, end, match_length))) return false;
+                match_length += min_match;
+                if (offset == 0 || offset > static_cast<size_t>(op - out) || match_length > static_cast<size_t>(out_end - op)) return false;
+
+                // Overlapping matches repeat a pattern; copy it in growing non-overlapping pieces
+                const uint8_t* ref = op - offset;
+                while (match_length) {
+                    size_t const piece = std::min(match_length, static_cast<size_t>(op - ref));
+                    memcpy(op, ref, piece);
+                    op += piece;
+                    match_length -= piece;
+                }
+            }
+            return op == out_end;
+        }
+
+    } // namespace lz
+
+    /**
+     * @brief Stream decorator that LZ-compresses fixed-size blocks on worker threads.
+     *
+     * The first write starts a frame and the first read (or seek) parses one; a stream is
+     * either writing or reading until begin(), clear() or close(). close() and the destructor
+     * finish a frame being written but leave the inner stream open. rdbuf() and save/load
+     * expose the inner stream, i.e. the compressed bytes.
+     *
+     * Misuse (reading while writing, corrupt or truncated input, reading past the end) sets
+     * failed() and yields zero bytes, like the other noexcept stream operations.
+     */
+    class CompressedStream final : public Stream {
+        static constexpr uint64_t header_magic = 0x314B4C425A4C5A4Dull; // "MZLZBLK1"
+        static constexpr uint64_t footer_magic = 0x58444E495A4C5A4Dull; // "MZLZINDX"
+        static constexpr size_t max_block_size = size_t{ 1 } << 24;
+
+        enum class Mode : uint8_t { idle, write, read };
+
+        Stream& inner_;
+        ThreadPool& pool_;
+        size_t block_size_;
+        size_t batch_blocks_;                    // blocks handed to the pool at once
+        Mode mode_ = Mode::idle;
+        bool failed_ = false;
+
+        std::vector<std::vector<char>> packed_;  // per-block compressed bytes of the batch
+        std::vector<size_t> packed_sizes_;
+        std::vector<size_t> raw_sizes_;
+        std::vector<uint64_t> index_;            // block offsets relative to the frame start
+        uint64_t raw_size_ = 0;
+
+        // Write side
+        std::vector<char> pending_;              // raw bytes not yet compressed
+        uint64_t frame_bytes_ = 0;               // bytes written to inner_ for this frame
+
+        // Read side
+        std::vector<char> decoded_;
+        size_t decoded_pos_ = 0;
+        size_t decoded_len_ = 0;
+        uint64_t decoded_base_ = 0;              // uncompressed offset of decoded_[0]
+        int64_t frame_start_ = -1;               // inner_ offset of the frame header, -1 if unknown
+        bool at_end_ = false;                    // end-of-blocks marker reached
+        bool short_block_ = false;               // a partial block was read; it must be the last
+        bool index_loaded_ = false;
+
+        void reset() noexcept {
+            mode_ = Mode::idle;
+            failed_ = false;
+            index_.clear();
+            raw_size_ = 0;
+            pending_.clear();
+            frame_bytes_ = 0;
+            decoded_pos_ = decoded_len_ = 0;
+            decoded_base_ = 0;
+            frame_start_ = -1;
+            at_end_ = short_block_ = index_loaded_ = false;
+        }
+
+        void prepare_batch() {
+            packed_.resize(batch_blocks_);
+            packed_sizes_.resize(batch_blocks_);
+            raw_sizes_.resize(batch_blocks_);
+        }
+
+        // --- Writing ---
+
+        void put(const void* ptr, size_t size) noexcept {
+            inner_.write(static_cast<const char*>(ptr), static_cast<int>(size));
+            frame_bytes_ += size;
+        }
+
+        void start_write() noexcept {
+            reset();
+            mode_ = Mode::write;
+            prepare_batch();
+            pending_.reserve(batch_blocks_ * block_size_);
+            uint32_t const block_size = static_cast<uint32_t>(block_size_);
+            put(&header_magic, sizeof(header_magic));
+            put(&block_size, sizeof(block_size));
+        }
+
+        // Compresses the first bytes of pending_ in parallel and writes the blocks in order
+        void write_batch(size_t bytes) noexcept {
+            size_t const blocks = (bytes + block_size_ - 1) / block_size_;
+            pool_.parallel_for(blocks, [&](size_t i) {
+                const char* raw = pending_.data() + i * block_size_;
+                uint32_t const raw_size = static_cast<uint32_t>(std::min(block_size_, bytes - i * block_size_));
+                auto& out = packed_[i];
+                if (out.size() < 8 + lz::max_compressed_size(block_size_)) out.resize(8 + lz::max_compressed_size(block_size_));
+                uint32_t stored = static_cast<uint32_t>(lz::compress(raw, raw_size, out.data() + 8));
+                if (stored >= raw_size) {
+                    memcpy(out.data() + 8, raw, raw_size);
+                    stored = raw_size;
+                }
+                memcpy(out.data(), &raw_size, 4);
+                memcpy(out.data() + 4, &stored, 4);
+                packed_sizes_[i] = 8 + size_t{ stored };
+            });
+            for (size_t i = 0; i < blocks; i++) {
+                index_.push_back(frame_bytes_);
+                put(packed_[i].data(), packed_sizes_[i]);
+            }
+            pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(bytes));
+        }
+
+        void finish() noexcept {
+            if (mode_ != Mode::write) return;
+            if (!pending_.empty()) write_batch(pending_.size());
+            uint32_t const terminator[2] = { 0, 0 };
+            put(terminator, sizeof(terminator));
+            uint64_t const index_offset = frame_bytes_;
+            uint32_t const count = static_cast<uint32_t>(index_.size());
+            put(&count, sizeof(count));
+            put(index_.data(), index_.size() * sizeof(uint64_t));
+            put(&raw_size_, sizeof(raw_size_));
+            put(&index_offset, sizeof(index_offset));
+            put(&footer_magic, sizeof(footer_magic));
+            inner_.flush();
+            mode_ = Mode::idle;
+        }
+
+        void write_bytes(const char* ptr, arg_type size) noexcept override final {
+            if (mode_ == Mode::read) { failed_ = true; return; }
+            if (mode_ == Mode::idle) start_write();
+            raw_size_ += static_cast<uint64_t>(size);
+            size_t const batch_bytes = batch_blocks_ * block_size_;
+            for (size_t left = static_cast<size_t>(size); left; ) {
+                size_t const n = std::min(left, batch_bytes - pending_.size());
+                pending_.insert(pending_.end(), ptr, ptr + n);
+                ptr += n;
+                left -= n;
+                if (pending_.size() == batch_bytes) write_batch(batch_bytes);
+            }
+        }
+
+        // --- Reading ---
+
+        void start_read() noexcept {
+            reset();
+            mode_ = Mode::read;
+            prepare_batch();
+            frame_start_ = inner_.tell();
+            uint64_t magic{ 0 };
+            uint32_t block_size{ 0 };
+            inner_.read(magic);
+            inner_.read(block_size);
+            if (magic != header_magic || block_size == 0 || block_size > max_block_size) {
+                failed_ = at_end_ = true;
+                return;
+            }
+            block_size_ = block_size;
+            decoded_.resize(batch_blocks_ * block_size_);
+        }
+
+        // Reads and decodes the next batch of blocks; false at the end of the frame
+        bool fill() noexcept {
+            decoded_base_ += decoded_len_;
+            decoded_pos_ = decoded_len_ = 0;
+            size_t blocks{ 0 };
+            while (!at_end_ && blocks < batch_blocks_) {
+                uint32_t header[2] = { UINT32_MAX, 0 }; // stays invalid if the inner stream is exhausted
+                inner_.read(header, 2);
+                if (header[0] == 0 && header[1] == 0) { at_end_ = true; break; }
+                if (header[0] > block_size_ || header[1] > header[0] || short_block_) {
+                    failed_ = at_end_ = true;
+                    return false;
+                }
+                short_block_ = header[0] < block_size_;
+                if (packed_[blocks].size() < header[1]) packed_[blocks].resize(header[1]);
+                inner_.read(packed_[blocks].data(), static_cast<int>(header[1]));
+                raw_sizes_[blocks] = header[0];
+                packed_sizes_[blocks] = header[1];
+                ++blocks;
+            }
+
+            std::atomic<bool> corrupt{ false };
+            pool_.parallel_for(blocks, [&](size_t i) {
+                char* out = decoded_.data() + i * block_size_;
+                if (packed_sizes_[i] == raw_sizes_[i]) memcpy(out, packed_[i].data(), raw_sizes_[i]);
+                else if (!lz::decompress(packed_[i].data(), packed_sizes_[i], out, raw_sizes_[i])) corrupt.store(true);
+            });
+            if (corrupt.load()) {
+                failed_ = at_end_ = true;
+                return false;
+            }
+            decoded_len_ = blocks ? (blocks - 1) * block_size_ + raw_sizes_[blocks - 1] : 0;
+            return decoded_len_ > 0;
+        }
+
+        bool load_index() noexcept {
+            if (index_loaded_) return true;
+            if (frame_start_ < 0) return false;
+            int64_t const here = inner_.tell();
+            inner_.seek(here);
+            inner_.end();
+            int64_t const total = inner_.tell();
+            uint64_t footer[3] = { 0, 0, 0 };
+            uint32_t count{ 0 };
+            bool valid = total >= frame_start_ + static_cast<int64_t>(sizeof(footer)) && inner_.seek(total - static_cast<int64_t>(sizeof(footer)));
+            if (valid) inner_.read(footer, 3);
+            // The index (u32 count, count u64 offsets) must lie between its offset and the footer
+            uint64_t const index_room = valid ? static_cast<uint64_t>(total - frame_start_) - sizeof(footer) : 0;
+            valid = valid && footer[2] == footer_magic && footer[1] <= index_room && index_room - footer[1] >= sizeof(count)
+                && inner_.seek(frame_start_ + static_cast<int64_t>(footer[1]));
+            if (valid) inner_.read(count);
+            valid = valid && !inner_.failed() && count <= static_cast<uint32_t>(INT_MAX)
+                && uint64_t{ count } * sizeof(uint64_t) <= index_room - footer[1] - sizeof(count)
+                && count == (footer[0] + block_size_ - 1) / block_size_;
+            if (valid) {
+                index_.resize(count);
+                inner_.read(index_.data(), static_cast<int>(count));
+                valid = !inner_.failed();
+                if (!valid) index_.clear();
+            }
+            if (valid) {
+                raw_size_ = footer[0];
+                index_loaded_ = true;
+            }
+            inner_.seek(here);
+            return valid;
+        }
+
+        void read_bytes(char* ptr, arg_type size) noexcept override final {
+            if (mode_ == Mode::idle) start_read();
+            size_t left = static_cast<size_t>(size);
+            while (left && mode_ == Mode::read && (decoded_pos_ < decoded_len_ || fill())) {
+                size_t const n = std::min(left, decoded_len_ - decoded_pos_);
+                memcpy(ptr, decoded_.data() + decoded_pos_, n);
+                decoded_pos_ += n;
+                ptr += n;
+                left -= n;
+            }
+            if (left) {
+                memset(ptr, 0, left);
+                failed_ = true;
+            }
+        }
+
+    public:
+        static constexpr size_t default_block_size = size_t{ 1 } << 16;
+
+        /**
+         * @brief Wraps inner; the decorator does not own it.
+         * @param block_size Uncompressed block size for writing (readers use the frame's).
+         * @param pool Pool that runs block compression and decompression.
+         * @throws std::invalid_argument if block_size is 0 or larger than 16 MiB.
+         */
+        explicit CompressedStream(Stream& inner, size_t block_size = default_block_size, ThreadPool& pool = ThreadPool::shared())
+            : inner_(inner), pool_(pool), block_size_(block_size), batch_blocks_(2 * pool.size()) {
+            INVALID_ARGUMENT_IF(block_size == 0 || block_size > max_block_size, "CompressedStream: invalid block size {}", block_size);
+        }
+
+        CompressedStream(const CompressedStream&) = delete;
+        ~CompressedStream() { finish(); }
+
+        /**
+         * @brief True after a failed read, a misuse of the stream mode or a failure of the inner stream.
+         */
+        bool failed() const noexcept override final { return failed_ || inner_.failed(); }
+
+        /**
+         * @brief Uncompressed block size of the current frame.
+         */
+        size_t block_size() const noexcept { return block_size_; }
+
+        /**
+         * @brief Writes the complete blocks buffered so far and flushes the inner stream.
+         *
+         * A trailing partial block stays buffered so every block but the last is full.
+         */
+        void flush() noexcept override final {
+            if (mode_ == Mode::write) {
+                size_t const full = pending_.size() / block_size_ * block_size_;
+                if (full) write_batch(full);
+            }
+            inner_.flush();
+        }
+
+        void close() override final { finish(); reset(); }
+
+        /**
+         * @brief Finishes a frame being written and rewinds the inner stream for reading.
+         */
+        void begin() override final {
+            finish();
+            reset();
+            inner_.begin();
+        }
+
+        void end() override final {
+            if (mode_ == Mode::idle) start_read();
+            if (mode_ != Mode::read) return;
+            if (load_index()) { seek(static_cast<int64_t>(raw_size_)); return; }
+            while (fill()) {}
+            decoded_pos_ = decoded_len_;
+        }
+
+        bool empty() noexcept override final {
+            if (mode_ == Mode::write) return raw_size_ == 0;
+            if (mode_ == Mode::idle) return inner_.empty();
+            return decoded_pos_ == decoded_len_ && !fill();
+        }
+
+        CompressedStream& clear() noexcept override final {
+            reset();
+            inner_.clear();
+            return *this;
+        }
+        CompressedStream& operator=(const Stream& rhs) noexcept override final { return clear() << rhs; }
+        CompressedStream& operator<<(const Stream& rhs) noexcept override final {
+            std::streambuf* buffer = rhs.rdbuf();
+            if (!buffer) return *this;
+            std::vector<char> chunk(block_size_);
+            for (std::streamsize n; (n = buffer->sgetn(chunk.data(), static_cast<std::streamsize>(chunk.size()))) > 0; ) {
+                write_bytes(chunk.data(), static_cast<arg_type>(n));
+            }
+            return *this;
+        }
+        std::streambuf* rdbuf() const noexcept override final { return inner_.rdbuf(); }
+        bool is_open() const noexcept override final { return inner_.is_open(); }
+        bool is_file() const noexcept override final { return inner_.is_file(); }
+        void save(const char* name) override final { finish(); inner_.save(name); }
+        void load(const char* name) override final { inner_.load(name); }
+
+        /**
+         * @brief Uncompressed position: bytes written so far, or the read cursor.
+         */
+        int64_t tell() noexcept override final {
+            if (mode_ == Mode::write) return static_cast<int64_t>(raw_size_);
+            if (mode_ == Mode::read) return static_cast<int64_t>(decoded_base_ + decoded_pos_);
+            return 0;
+        }
+
+        /**
+         * @brief Moves the read cursor to an uncompressed offset using the block index.
+         *
+         * Only the batch starting at the target block is decoded.
+         * @return false while writing, if the index is unavailable, or if offset is out of range.
+         */
+        bool seek(int64_t offset) noexcept override final {
+            if (mode_ == Mode::idle) start_read();
+            if (mode_ != Mode::read || !load_index() || offset < 0 || static_cast<uint64_t>(offset) > raw_size_) return false;
+            uint64_t const target = static_cast<uint64_t>(offset);
+            if (target >= decoded_base_ && target - decoded_base_ < decoded_len_) {
+                decoded_pos_ = static_cast<size_t>(target - decoded_base_);
+                return true;
+            }
+            size_t const block = static_cast<size_t>(target / block_size_);
+            decoded_base_ = static_cast<uint64_t>(block) * block_size_;
+            decoded_pos_ = decoded_len_ = 0;
+            short_block_ = false;
+            if (block == index_.size()) { // the end of a frame made of full blocks
+                at_end_ = true;
+                return true;
+            }
+            at_end_ = false;
+            if (!inner_.seek(frame_start_ + static_cast<int64_t>(index_[block]))) return false;
+            fill();
+            decoded_pos_ = static_cast<size_t>(target - decoded_base_);
+            return !failed_ && decoded_pos_ <= decoded_len_;
+        }
+    };
+
+} // namespace mz
+
+#endif // MZ_COMPRESS_HEADER_FILE
@@ -0,0 +1,352 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_ENCODING_HEADER_FILE
+#define MZ_ENCODING_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstring>
+#include <vector>
+#include "globals.h"
+#include "zstream.h"
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <immintrin.h>
+#define MZ_ENCODING_SSSE3 1
+#endif
+
+/**
+ * @file zencoding.h
+ * @brief Compact integer encodings for serializing integral sequences through mz::Stream.
+ *
+ * This header defines:
+ *   - mz::IntEncoding: fixed, varint (LEB128), zigzag, delta and stream_vbyte.
+ *   - mz::write_integers / mz::read_integers: labelled, length-prefixed encoded blocks.
+ *
+ * Every block starts with a label that records the encoding and the element width, so
+ * the reader always picks the matching decoder. Vector<T>::save_encoded/load_encoded
+ * (and therefore XA) are built on these functions.
+ *
+ * Encodings:
+ *   - fixed:        raw little-endian values (same bytes as Vector::save).
+ *   - varint:       each value as an unsigned LEB128 varint.
+ *   - zigzag:       zigzag-mapped values as varints (small negative values stay short).
+ *   - delta:        zigzag-mapped differences of consecutive values as varints.
+ *   - stream_vbyte: zigzag deltas in the stream-vbyte layout (2-bit length codes plus
+ *                   packed bytes), decoded with SSSE3 shuffles when available.
+ *                   Only 32-bit and narrower types; wider types are written as delta.
+ *
+ * Usage example:
+ *   XA ids = ...;                                 // sorted ids
+ *   ids.save_encoded(stream, mz::IntEncoding::stream_vbyte);
+ *   XA loaded;
+ *   if (loaded.load_encoded(stream)) { ... }       // true on label mismatch
+ */
+
+namespace mz {
+
+    /**
+     * @brief Integer encodings understood by write_integers/read_integers.
+     */
+    enum class IntEncoding : uint8_t { fixed, varint, zigzag, delta, stream_vbyte };
+
+    namespace encoding {
+
+        inline constexpr uint64_t label_magic = 0x4D5A494E54000000ull; // "MZINT" in the high bytes
+        inline constexpr uint64_t label_mask = 0xFFFFFFFFFF000000ull;
+
+        /**
+         * @brief Label for an encoded block of T; the low bytes hold sizeof(T) and the encoding.
+         */
+        template <std::integral T>
+        constexpr uint64_t label(IntEncoding encoding) noexcept {
+            return label_magic | (static_cast<uint64_t>(sizeof(T)) << 8) | static_cast<uint64_t>(encoding);
+        }
+
+        /**
+         * @brief Maps signed differences to unsigned values: 0,-1,1,-2,... -> 0,1,2,3,...
+         */
+        template <std::unsigned_integral U>
+        constexpr U zigzag(U value) noexcept {
+            using S = std::make_signed_t<U>;
+            return static_cast<U>(value << 1) ^ static_cast<U>(static_cast<S>(value) >> (sizeof(U) * 8 - 1));
+        }
+
+        template <std::unsigned_integral U>
+        constexpr U unzigzag(U value) noexcept { return (value >> 1) ^ (U{ 0 } - (value & 1)); }
+
+        inline uint8_t* put_varint(uint8_t* out, uint64_t value) noexcept {
+            while (value >= 0x80) {
+                *out++ = static_cast<uint8_t>(value) | 0x80;
+                value >>= 7;
+            }
+            *out++ = static_cast<uint8_t>(value);
+            return out;
+        }
+
+        /**
+         * @brief Decodes one varint; returns nullptr if the input ends mid-value.
+         */
+        inline const uint8_t* get_varint(const uint8_t* in, const uint8_t* end, uint64_t& value) noexcept {
+            value = 0;
+            for (int shift = 0; in < end && shift < 64; shift += 7) {
+                uint8_t const byte = *in++;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return in;
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief Upper bound on the encoded size of count values of T.
+         */
+        template <std::integral T>
+        constexpr size_t max_bytes(size_t count, IntEncoding encoding) noexcept {
+            switch (encoding) {
+            case IntEncoding::fixed: return count * sizeof(T);
+            case IntEncoding::stream_vbyte: return (count + 3) / 4 + count * 4;
+            default: return count * ((sizeof(T) * 8 + 6) / 7);
+            }
+        }
+
+        /**
+         * @brief Lookup tables for stream-vbyte: per control byte, the packed length of the
+         * four values and the pshufb mask that spreads them into 32-bit lanes.
+         */
+        struct StreamVByteTables {
+            std::array<uint8_t, 256> length{};
+            std::array<std::array<uint8_t, 16>, 256> shuffle{};
+
+            constexpr StreamVByteTables() noexcept {
+                for (int control = 0; control < 256; control++) {
+                    uint8_t offset{ 0 };
+                    for (int lane = 0; lane < 4; lane++) {
+                        int const bytes = ((control >> (2 * lane)) & 3) + 1;
+                        for (int b = 0; b < 4; b++) {
+                            shuffle[control][lane * 4 + b] = b < bytes ? static_cast<uint8_t>(offset + b) : 0xFF;
+                        }
+                        offset = static_cast<uint8_t>(offset + bytes);
+                    }
+                    length[control] = offset;
+                }
+            }
+        };
+
+        inline constexpr StreamVByteTables stream_vbyte_tables{};
+
+        /**
+         * @brief Packs zigzag deltas of 32-bit values; returns the number of bytes written.
+         */
+        inline size_t stream_vbyte_encode(const uint32_t* values, size_t count, uint8_t* out) noexcept {
+            uint8_t* control = out;
+            uint8_t* data = out + (count + 3) / 4;
+            memset(control, 0, (count + 3) / 4);
+            uint32_t previous{ 0 };
+            for (size_t i = 0; i < count; i++) {
+                uint32_t const value = zigzag(static_cast<uint32_t>(values[i] - previous));
+                previous = values[i];
+                int const bytes = value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+                control[i >> 2] |= static_cast<uint8_t>((bytes - 1) << (2 * (i & 3)));
+                memcpy(data, &value, bytes); // little-endian low bytes
+                data += bytes;
+            }
+            return static_cast<size_t>(data - out);
+        }
+
+        /**
+         * @brief Unpacks stream_vbyte_encode output; returns false if the input is truncated.
+         */
+        inline bool stream_vbyte_decode(const uint8_t* in, size_t length, uint32_t* values, size_t count) noexcept {
+            size_t const control_bytes = (count + 3) / 4;
+            if (length < control_bytes) return false;
+            const uint8_t* control = in;
+            const uint8_t* data = in + control_bytes;
+            const uint8_t* const end = in + length;
+            size_t i{ 0 };
+            uint32_t previous{ 0 };
+
+#if defined(MZ_ENCODING_SSSE3)
+            // Four values per control byte; stop while a full 16-byte load still fits.
+            __m128i last = _mm_setzero_si128();
+            __m128i const one = _mm_set1_epi32(1);
+            for (; i + 4 <= count && data + 16 <= end; i += 4) {
+                uint8_t const c = control[i >> 2];
+                __m128i const packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                __m128i const mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stream_vbyte_tables.shuffle[c].data()));
+                __m128i v = _mm_shuffle_epi8(packed, mask);
+                data += stream_vbyte_tables.length[c];
+                v = _mm_xor_si128(_mm_srli_epi32(v, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(v, one)));
+                v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+                v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+                v = _mm_add_epi32(v, last);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), v);
+                last = _mm_shuffle_epi32(v, 0xFF);
+            }
+            previous = static_cast<uint32_t>(_mm_cvtsi128_si32(last));
+#endif
+
+            for (; i < count; i++) {
+                int const bytes = ((control[i >> 2] >> (2 * (i & 3))) & 3) + 1;
+                if (data + bytes > end) return false;
+                uint32_t value{ 0 };
+                memcpy(&value, data, bytes);
+                data += bytes;
+                previous += unzigzag(value);
+                values[i] = previous;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Encodes count values into out (sized by max_bytes); returns the bytes used.
+         */
+        template <std::integral T>
+        size_t encode(const T* values, size_t count, IntEncoding encoding, uint8_t* out) noexcept {
+            using U = std::make_unsigned_t<T>;
+            uint8_t* ptr = out;
+            U previous{ 0 };
+            switch (encoding) {
+            case IntEncoding::fixed:
+                memcpy(out, values, count * sizeof(T));
+                return count * sizeof(T);
+            case IntEncoding::varint:
+                for (size_t i = 0; i < count; i++) ptr = put_varint(ptr, static_cast<U>(values[i]));
+                break;
+            case IntEncoding::zigzag:
+                for (size_t i = 0; i < count; i++) ptr = put_varint(ptr, zigzag(static_cast<U>(values[i])));
+                break;
+            case IntEncoding::delta:
+                for (size_t i = 0; i < count; i++) {
+                    ptr = put_varint(ptr, zigzag(static_cast<U>(static_cast<U>(values[i]) - previous)));
+                    previous = static_cast<U>(values[i]);
+                }
+                break;
+            case IntEncoding::stream_vbyte:
+                if constexpr (sizeof(T) == 4) {
+                    return stream_vbyte_encode(reinterpret_cast<const uint32_t*>(values), count, out);
+                }
+                break;
+            }
+            return static_cast<size_t>(ptr - out);
+        }
+
+        /**
+         * @brief Decodes count values; returns false if the payload is truncated or malformed.
+         */
+        template <std::integral T>
+        bool decode(const uint8_t* in, size_t length, IntEncoding encoding, T* values, size_t count) noexcept {
+            using U = std::make_unsigned_t<T>;
+            const uint8_t* const end = in + length;
+            uint64_t raw{ 0 };
+            U previous{ 0 };
+            switch (encoding) {
+            case IntEncoding::fixed:
+                if (length != count * sizeof(T)) return false;
+                memcpy(values, in, length);
+                return true;
+            case IntEncoding::varint:
+            case IntEncoding::zigzag:
+            case IntEncoding::delta:
+                for (size_t i = 0; i < count; i++) {
+                    if (!(in = get_varint(in, end, raw))) return false;
+                    U value = static_cast<U>(raw);
+                    if (encoding != IntEncoding::varint) value = unzigzag(value);
+                    if (encoding == IntEncoding::delta) value = previous = static_cast<U>(previous + value);
+                    values[i] = static_cast<T>(value);
+                }
+                return in == end;
+            case IntEncoding::stream_vbyte:
+                if constexpr (sizeof(T) == 4) {
+                    return stream_vbyte_decode(in, length, reinterpret_cast<uint32_t*>(values), count);
+                }
+                return false;
+            }
+            return false;
+        }
+
+    } // namespace encoding
+
+    /**
+     * @brief Writes count integers as one labelled, encoded block.
+     *
+     * Layout: label (encoding and element width), varint count, varint byte length, payload.
+     * stream_vbyte on element types wider than 32 bits is written as delta.
+     *
+     * Usage:
+     *   mz::write_integers(stream, ids.data(), ids.size(), mz::IntEncoding::delta);
+     */
+    template <std::integral T>
+    void write_integers(Stream& s, const T* values, size_type count, IntEncoding encoding) noexcept {
+        if (encoding == IntEncoding::stream_vbyte && sizeof(T) != 4) encoding = IntEncoding::delta;
+        size_t const n = count > 0 ? static_cast<size_t>(count) : 0;
+        std::vector<uint8_t> bytes(encoding::max_bytes<T>(n, encoding));
+        size_t const length = encoding::encode(values, n, encoding, bytes.data());
+        s.write_label(encoding::label<T>(encoding));
+        s.write_varint(n);
+        s.write_varint(length);
+        for (size_t done = 0; done < length; ) {    // payloads of 2^31 bytes and more go in pieces
+            int const piece = static_cast<int>(std::min<size_t>(length - done, INT_MAX));
+            s.write(bytes.data() + done, piece);
+            done += static_cast<size_t>(piece);
+        }
+    }
+
+    /**
+     * @brief Reads a block written by write_integers.
+     *
+     * The label selects the decoder. allocate(count) must return storage for count values.
+     * @return true on error (unknown label, element width mismatch or corrupt payload), false on success.
+     *
+     * Usage:
+     *   bool failed = mz::read_integers<int>(stream, [&](size_type n) { v.resize(n, false); return v.data(); });
+     */
+    template <std::integral T, typename Allocator>
+        requires requires(Allocator&& allocate, size_type n) { { allocate(n) } -> std::same_as<T*>; }
+    bool read_integers(Stream& s, Allocator&& allocate) noexcept {
+        uint64_t label{ 0 };
+        s.read(label);
+        auto const encoding = static_cast<IntEncoding>(label & 0xFF);
+        if ((label & encoding::label_mask) != encoding::label_magic) return true;
+        if (((label >> 8) & 0xFF) != sizeof(T) || encoding > IntEncoding::stream_vbyte) return true;
+
+        uint64_t const count = s.read_varint();
+        uint64_t const length = s.read_varint();
+        if (s.failed() || count > static_cast<uint64_t>(INT_MAX) || length > encoding::max_bytes<T>(count, encoding)) return true;
+
+        std::vector<uint8_t> bytes(static_cast<size_t>(length));
+        for (size_t done = 0; done < bytes.size(); ) {
+            int const piece = static_cast<int>(std::min<size_t>(bytes.size() - done, INT_MAX));
+            s.read(bytes.data() + done, piece);
+            done += static_cast<size_t>(piece);
+        }
+        if (s.failed()) return true;
+        T* values = allocate(static_cast<size_type>(count));
+        return !encoding::decode(bytes.data(), bytes.size(), encoding, values, static_cast<size_t>(count));
+    }
+
+} // namespace mz
+
+#endif // MZ_ENCODING_HEADER_FILE
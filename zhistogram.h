@@ -0,0 +1,247 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef MZ_HISTOGRAM_HEADER_FILE
+#define MZ_HISTOGRAM_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <span>
+#include "globals.h"
+#include "zstream.h"
+
+/**
+ * @file zhistogram.h
+ * @brief Fixed-size, log-bucketed latency histogram (HDR style).
+ *
+ * This header defines:
+ *   - mz::LatencyHistogram: O(1) record, fixed memory, percentiles, merge, Stream save/load.
+ *   - std::formatter<mz::LatencyHistogram>: "n=.. p50=.. p90=.. p99=.. p99.9=.. max=.." in ns.
+ *
+ * Values (nanoseconds, any non-negative int64) are counted in buckets of 64 linear
+ * sub-buckets per power of two, so every reported value is within 1/64 (1.6%) of the
+ * recorded one, and the whole int64 range fits in 3712 counters (29 KB). Reported
+ * percentiles are the upper bound of the bucket that holds them, clamped to the exact max.
+ *
+ * Keep one histogram per thread and merge() them for the report; recording does not
+ * synchronize.
+ *
+ * Stream layout (bracketed by labels, as in Vector::save3):
+ *   u64 magic "MZHIST01" | u32 sub-bucket bits | u64 count, min, max, sum |
+ *   u32 non-empty buckets | per bucket: u32 index, u64 count
+ *
+ * Usage example:
+ *   mz::LatencyHistogram h;
+ *   mz::SteadyTimer t;
+ *   t.attach(h);                       // every stamp() records its interval
+ *   for (...) { step(); t.stamp(); }
+ *   mz::print("{}\n", h);              // n=1000 p50=812 p90=950 p99=1730 p99.9=4100 max=5022
+ */
+
+namespace mz {
+
+    class LatencyHistogram {
+        static constexpr uint64_t magic = 0x3130545349485A4Dull; // "MZHIST01"
+
+    public:
+        static constexpr int sub_bucket_bits = 6;
+        static constexpr int64_t sub_bucket_count = int64_t{ 1 } << sub_bucket_bits;
+        static constexpr size_t bucket_count = static_cast<size_t>((64 - sub_bucket_bits) * sub_bucket_count);
+
+    private:
+        std::array<uint64_t, bucket_count> counts_{};
+        uint64_t count_ = 0;
+        int64_t min_ = INT64_MAX;
+        int64_t max_ = 0;
+        int64_t sum_ = 0;
+
+    public:
+        /**
+         * @brief Bucket index of a value: linear below 64, then 64 sub-buckets per power of two.
+         */
+        static constexpr size_t index_of(int64_t value) noexcept {
+            uint64_t const v = value < 0 ? 0 : static_cast<uint64_t>(value);
+            if (v < static_cast<uint64_t>(sub_bucket_count)) return static_cast<size_t>(v);
+            int const shift = std::bit_width(v) - 1 - sub_bucket_bits;
+            return static_cast<size_t>(((shift + 1) << sub_bucket_bits) + static_cast<int64_t>(v >> shift) - sub_bucket_count);
+        }
+
+        /**
+         * @brief Smallest value that falls into bucket @p index.
+         */
+        static constexpr int64_t lowest_of(size_t index) noexcept {
+            int64_t const bucket = static_cast<int64_t>(index >> sub_bucket_bits);
+            int64_t const sub = static_cast<int64_t>(index & (sub_bucket_count - 1));
+            if (bucket == 0) return sub;
+            return (sub + sub_bucket_count) << (bucket - 1);
+        }
+
+        /**
+         * @brief Largest value that falls into bucket @p index.
+         */
+        static constexpr int64_t highest_of(size_t index) noexcept {
+            int64_t const bucket = static_cast<int64_t>(index >> sub_bucket_bits);
+            return bucket < 2 ? lowest_of(index) : lowest_of(index) + ((int64_t{ 1 } << (bucket - 1)) - 1);
+        }
+
+        /**
+         * @brief Records one value (negative values count as 0).
+         */
+        void record(int64_t value) noexcept {
+            value = (std::max)(value, int64_t{ 0 });
+            counts_[index_of(value)]++;
+            count_++;
+            sum_ += value;
+            min_ = (std::min)(min_, value);
+            max_ = (std::max)(max_, value);
+        }
+
+        /**
+         * @brief Records @p n occurrences of a value.
+         */
+        void record(int64_t value, uint64_t n) noexcept {
+            if (n == 0) return;
+            value = (std::max)(value, int64_t{ 0 });
+            counts_[index_of(value)] += n;
+            count_ += n;
+            sum_ += value * static_cast<int64_t>(n);
+            min_ = (std::min)(min_, value);
+            max_ = (std::max)(max_, value);
+        }
+
+        /**
+         * @brief Adds all counts of @p other (e.g. another thread's histogram).
+         */
+        void merge(const LatencyHistogram& other) noexcept {
+            if (other.count_ == 0) return;
+            for (size_t i = 0; i < bucket_count; i++) counts_[i] += other.counts_[i];
+            count_ += other.count_;
+            sum_ += other.sum_;
+            min_ = (std::min)(min_, other.min_);
+            max_ = (std::max)(max_, other.max_);
+        }
+
+        void reset() noexcept { *this = LatencyHistogram(); }
+
+        uint64_t count() const noexcept { return count_; }
+        bool empty() const noexcept { return count_ == 0; }
+        int64_t min() const noexcept { return count_ ? min_ : 0; }
+        int64_t max() const noexcept { return max_; }
+        int64_t sum() const noexcept { return sum_; }
+        double mean() const noexcept { return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0; }
+
+        /**
+         * @brief Value at percentile @p p (0..100): the upper bound of the bucket holding
+         *        the ceil(p% * count)-th smallest value, clamped to [min, max]. 0 when empty.
+         */
+        int64_t percentile(double p) const noexcept {
+            if (count_ == 0) return 0;
+            p = std::clamp(p, 0.0, 100.0);
+            uint64_t rank = static_cast<uint64_t>(std::ceil(p * static_cast<double>(count_) / 100.0));
+            rank = std::clamp<uint64_t>(rank, 1, count_);
+            uint64_t seen{ 0 };
+            for (size_t i = 0; i < bucket_count; i++) {
+                seen += counts_[i];
+                if (seen >= rank) return std::clamp(highest_of(i), min_, max_);
+            }
+            return max_;
+        }
+
+        int64_t p50() const noexcept { return percentile(50.0); }
+        int64_t p90() const noexcept { return percentile(90.0); }
+        int64_t p99() const noexcept { return percentile(99.0); }
+        int64_t p999() const noexcept { return percentile(99.9); }
+
+        /**
+         * @brief Raw bucket counts, indexable with index_of / lowest_of / highest_of.
+         */
+        std::span<const uint64_t> buckets() const noexcept { return counts_; }
+
+        /**
+         * @brief Writes the non-empty buckets and the summary to s.
+         */
+        void save(Stream& s, uint64_t Enc = 0) const noexcept {
+            s.write_label(Enc);
+            s << magic << static_cast<uint32_t>(sub_bucket_bits) << count_ << min_ << max_ << sum_;
+            uint32_t used{ 0 };
+            for (uint64_t c : counts_) used += c != 0;
+            s << used;
+            for (size_t i = 0; i < bucket_count; i++) {
+                if (counts_[i]) s << static_cast<uint32_t>(i) << counts_[i];
+            }
+            s.write_label(Enc);
+        }
+
+        /**
+         * @brief Replaces the contents with a histogram written by save().
+         * @return true on error (label, magic or layout mismatch, or truncated data).
+         */
+        bool load(Stream& s, uint64_t Enc = 0) noexcept {
+            reset();
+            if (s.read_label(Enc)) return true;
+            uint64_t m{ 0 };
+            uint32_t bits{ 0 }, used{ 0 };
+            s >> m >> bits >> count_ >> min_ >> max_ >> sum_ >> used;
+            if (m != magic || bits != sub_bucket_bits || used > bucket_count || s.failed()) return true;
+            uint64_t total{ 0 };
+            for (uint32_t i = 0; i < used; i++) {
+                uint32_t index{ UINT32_MAX };
+                uint64_t c{ 0 };
+                s >> index >> c;
+                if (index >= bucket_count) return true;
+                counts_[index] = c;
+                total += c;
+            }
+            return total != count_ || s.failed() || s.read_label(Enc);
+        }
+    };
+
+} // namespace mz
+
+
+/**
+ * @brief Formats a LatencyHistogram summary. The spec applies to each value, e.g. "{:>8}".
+ */
+template <>
+struct std::formatter<mz::LatencyHistogram> : std::formatter<int64_t> {
+    auto format(const mz::LatencyHistogram& h, std::format_context& ctx) const {
+        auto out = std::format_to(ctx.out(), "n={}", h.count());
+        auto field = [&](const char* name, int64_t value) {
+            out = std::format_to(out, " {}=", name);
+            ctx.advance_to(out);
+            out = std::formatter<int64_t>::format(value, ctx);
+        };
+        field("p50", h.p50());
+        field("p90", h.p90());
+        field("p99", h.p99());
+        field("p99.9", h.p999());
+        field("max", h.max());
+        return out;
+    }
+};
+
+#endif // MZ_HISTOGRAM_HEADER_FILE
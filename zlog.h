@@ -0,0 +1,382 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_LOG_HEADER_FILE
+#define MZ_LOG_HEADER_FILE
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "globals.h"
+#include "string_utils.h"
+
+/**
+ * @file zlog.h
+ * @brief Asynchronous logging sink with per-thread buffers.
+ *
+ * This header defines:
+ *   - mz::LogLevel, mz::LogOverflow and mz::LogOptions.
+ *   - mz::Logger: formats each message on the calling thread into preallocated storage,
+ *     copies it into that thread's lock-free ring buffer and leaves the I/O to a background
+ *     flusher thread, which writes everything pending with one fwrite per round.
+ *   - MZ_LOG_TRACE ... MZ_LOG_ERROR: leveled logging macros. Levels below MZ_LOG_LEVEL
+ *     compile out entirely (arguments are not evaluated); the rest are filtered at run time.
+ *
+ * A hot thread never waits for stdout's lock or for the disk: when its ring is full, the
+ * message is dropped and counted (LogOverflow::drop, the default) and the flusher reports
+ * the count. LogOverflow::block waits for space instead, for runs where nothing may be lost.
+ * Messages of one thread keep their order; messages of different threads are interleaved
+ * per flush round. Long messages are queued as several records and come out whole; one
+ * too large for the ring is written directly, after everything queued before it.
+ *
+ * Logger::capture_print() routes mz::print (and with it the error macros of error_utils.h)
+ * through the same buffers. Printed text and error-level messages are never dropped: with
+ * a full ring they are written directly instead. The error macros flush before throwing.
+ *
+ * Usage example:
+ *   mz::Logger::instance().configure({ .level = mz::LogLevel::debug });
+ *   mz::Logger::instance().capture_print();
+ *   MZ_LOG_INFO("epoch {} loss {:.4f}", epoch, loss);
+ *   mz::print("progress {}%\n", pct);     // buffered as well
+ *   mz::Logger::instance().flush();       // synchronous, e.g. before a crash dump
+ */
+
+#ifndef MZ_LOG_LEVEL
+#if defined(NDEBUG)
+#define MZ_LOG_LEVEL 2      // compile out trace and debug
+#else
+#define MZ_LOG_LEVEL 0
+#endif
+#endif
+
+namespace mz {
+
+    enum class LogLevel : uint8_t { trace, debug, info, warn, error, off };
+
+    enum class LogOverflow : uint8_t { drop, block };
+
+    struct LogOptions {
+        LogLevel level = LogLevel::info;
+        LogOverflow overflow = LogOverflow::drop;
+        size_t ring_bytes = size_t{ 1 } << 20;                  // per thread, rounded up to a power of two
+        std::chrono::milliseconds flush_interval{ 10 };
+        FILE* output = stdout;
+    };
+
+    class Logger {
+        // Single-producer (owning thread) single-consumer (flusher) byte ring of
+        // u32 length-prefixed records; head and tail only grow
+        struct Ring {
+            std::unique_ptr<char[]> data;
+            size_t mask = 0;
+            alignas(64) std::atomic<size_t> head{ 0 };
+            alignas(64) std::atomic<size_t> tail{ 0 };
+            std::atomic<uint64_t> dropped{ 0 };
+            std::atomic<bool> retired{ false };   // owning thread has exited
+
+            explicit Ring(size_t bytes) : data(new char[bytes]), mask(bytes - 1) {}
+
+            void put(size_t at, const char* src, size_t n) noexcept {
+                size_t const offset = at & mask;
+                size_t const first = std::min(n, mask + 1 - offset);
+                memcpy(data.get() + offset, src, first);
+                memcpy(data.get(), src + first, n - first);
+            }
+            void get(size_t at, char* dst, size_t n) const noexcept {
+                size_t const offset = at & mask;
+                size_t const first = std::min(n, mask + 1 - offset);
+                memcpy(dst, data.get() + offset, first);
+                memcpy(dst + first, data.get(), n - first);
+            }
+        };
+
+        struct LocalRing {
+            std::shared_ptr<Ring> ring;
+            ~LocalRing() { if (ring) ring->retired.store(true, std::memory_order_release); }
+        };
+
+        static constexpr size_t max_message = 4096;           // longer messages span several records
+
+        LogOptions options_;
+        std::atomic<int> level_{ static_cast<int>(LogLevel::info) };
+        std::atomic<size_t> ring_bytes_{ size_t{ 1 } << 20 };
+        std::atomic<bool> block_{ false };
+
+        std::mutex rings_mutex_;
+        std::vector<std::shared_ptr<Ring>> rings_;
+
+        std::mutex drain_mutex_;                                // one drain at a time
+        std::string batch_;
+        uint64_t reported_dropped_ = 0;
+        uint64_t retired_dropped_ = 0;                          // drops of rings already removed
+
+        std::mutex wake_mutex_;
+        std::condition_variable wake_;
+        bool stop_ = false;
+        std::thread flusher_;
+
+        Ring& local_ring() {
+            thread_local LocalRing local;
+            if (!local.ring) {
+                size_t const bytes = std::bit_ceil(std::max<size_t>(ring_bytes_.load(std::memory_order_relaxed), max_message + 4));
+                local.ring = std::make_shared<Ring>(bytes);
+                std::lock_guard lock(rings_mutex_);
+                rings_.push_back(local.ring);
+            }
+            return *local.ring;
+        }
+
+        // Queues message as records of at most max_message bytes, all of them or none.
+        // Without room it waits (LogOverflow::block), writes directly (keep) or drops.
+        bool push(std::string_view message, bool keep = false) noexcept {
+            Ring& ring = local_ring();
+            size_t const records = std::max<size_t>(1, (message.size() + max_message - 1) / max_message);
+            size_t const need = records * sizeof(uint32_t) + message.size();
+            size_t const capacity = ring.mask + 1;
+            if (need > capacity) {
+                write_direct(message);
+                return true;
+            }
+            size_t const head = ring.head.load(std::memory_order_relaxed);
+            for (;;) {
+                size_t const used = head - ring.tail.load(std::memory_order_acquire);
+                if (capacity - used >= need) break;
+                if (!block_.load(std::memory_order_relaxed)) {
+                    if (keep) {
+                        write_direct(message);
+                        return true;
+                    }
+                    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                wake_.notify_one();
+                std::this_thread::yield();
+            }
+            size_t at = head;
+            size_t offset = 0;
+            do {
+                uint32_t const length = static_cast<uint32_t>(std::min(message.size() - offset, max_message));
+                ring.put(at, reinterpret_cast<const char*>(&length), sizeof(length));
+                ring.put(at + sizeof(length), message.data() + offset, length);
+                at += sizeof(length) + length;
+                offset += length;
+            } while (offset < message.size());
+            ring.head.store(at, std::memory_order_release);
+            // Nudge the flusher when the ring crosses half full, not on every message
+            size_t const half = capacity / 2;
+            size_t const before = head - ring.tail.load(std::memory_order_relaxed);
+            if (before < half && before + need >= half) wake_.notify_one();
+            return true;
+        }
+
+        void drain() noexcept {
+            std::lock_guard drain_lock(drain_mutex_);
+            drain_locked();
+        }
+
+        // Writes message synchronously, after everything already queued
+        void write_direct(std::string_view message) noexcept {
+            std::lock_guard drain_lock(drain_mutex_);
+            drain_locked();
+            FILE* output = options_.output ? options_.output : stdout;
+            fwrite(message.data(), 1, message.size(), output);
+            fflush(output);
+        }
+
+        void drain_locked() noexcept {
+            std::vector<std::shared_ptr<Ring>> rings;
+            {
+                std::lock_guard lock(rings_mutex_);
+                rings = rings_;
+            }
+            batch_.clear();
+            uint64_t dropped{ retired_dropped_ };
+            for (auto const& ring : rings) {
+                bool const retired = ring->retired.load(std::memory_order_acquire);
+                size_t tail = ring->tail.load(std::memory_order_relaxed);
+                size_t const head = ring->head.load(std::memory_order_acquire);
+                while (tail != head) {
+                    uint32_t length{ 0 };
+                    ring->get(tail, reinterpret_cast<char*>(&length), sizeof(length));
+                    size_t const at = batch_.size();
+                    batch_.resize(at + length);
+                    ring->get(tail + sizeof(length), batch_.data() + at, length);
+                    tail += sizeof(length) + length;
+                }
+                ring->tail.store(tail, std::memory_order_release);
+                dropped += ring->dropped.load(std::memory_order_relaxed);
+                if (retired) {
+                    // Nothing more can arrive from an exited thread
+                    retired_dropped_ += ring->dropped.load(std::memory_order_relaxed);
+                    std::lock_guard lock(rings_mutex_);
+                    std::erase(rings_, ring);
+                }
+            }
+            if (dropped > reported_dropped_) {
+                std::format_to(std::back_inserter(batch_), "[mz::Logger: {} messages dropped]\n", dropped - reported_dropped_);
+                reported_dropped_ = dropped;
+            }
+            FILE* output = options_.output ? options_.output : stdout;
+            if (!batch_.empty()) {
+                fwrite(batch_.data(), 1, batch_.size(), output);
+                fflush(output);
+            }
+        }
+
+        void run() {
+            std::unique_lock lock(wake_mutex_);
+            while (!stop_) {
+                wake_.wait_for(lock, options_.flush_interval);
+                lock.unlock();
+                drain();
+                lock.lock();
+            }
+        }
+
+        static void print_write(std::string_view sv) noexcept { instance().push(sv, true); }
+        static void print_flush_all() noexcept { instance().flush(); }
+        static constexpr PrintSink sink_{ &print_write, &print_flush_all };
+
+        Logger() : flusher_([this] { run(); }) {}
+
+    public:
+        Logger(Logger const&) = delete;
+        Logger& operator=(Logger const&) = delete;
+
+        ~Logger() {
+            capture_print(false);
+            {
+                std::lock_guard lock(wake_mutex_);
+                stop_ = true;
+            }
+            wake_.notify_one();
+            flusher_.join();
+            drain();
+        }
+
+        /**
+         * @brief The process-wide logger; its flusher thread starts on first use.
+         */
+        static Logger& instance() {
+            static Logger logger;
+            return logger;
+        }
+
+        /**
+         * @brief Applies options. ring_bytes affects threads that have not logged yet.
+         */
+        void configure(const LogOptions& options) {
+            {
+                std::lock_guard lock(drain_mutex_);
+                std::lock_guard wake(wake_mutex_);
+                options_ = options;
+            }
+            level_.store(static_cast<int>(options.level), std::memory_order_relaxed);
+            ring_bytes_.store(options.ring_bytes, std::memory_order_relaxed);
+            block_.store(options.overflow == LogOverflow::block, std::memory_order_relaxed);
+        }
+
+        void set_level(LogLevel level) noexcept { level_.store(static_cast<int>(level), std::memory_order_relaxed); }
+        LogLevel level() const noexcept { return static_cast<LogLevel>(level_.load(std::memory_order_relaxed)); }
+        bool enabled(LogLevel level) const noexcept { return static_cast<int>(level) >= level_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Routes mz::print through this logger (or back to stdout with false).
+         */
+        void capture_print(bool on = true) noexcept {
+            if (!on) drain();
+            print_sink.store(on ? &sink_ : nullptr, std::memory_order_release);
+        }
+
+        /**
+         * @brief Queues raw text, without level prefix or newline.
+         * @return false if the message was dropped.
+         */
+        bool write(std::string_view text) noexcept { return push(text); }
+
+        /**
+         * @brief Formats "[level] message\n" on the calling thread and queues it.
+         *
+         * Messages that do not fit the preallocated buffer are formatted again into a string.
+         * @return false if the level is disabled or the message was dropped.
+         */
+        template <typename... TArgs>
+        bool log(LogLevel level, std::format_string<TArgs...> fmt, TArgs&&... args) noexcept {
+            static constexpr std::string_view prefix[] = { "[trace] ", "[debug] ", "[info] ", "[warn] ", "[error] ", "" };
+            if (level == LogLevel::off || !enabled(level)) return false;
+            thread_local char buffer[max_message];
+            std::string_view const head = prefix[static_cast<int>(level)];
+            memcpy(buffer, head.data(), head.size());
+            size_t const room = max_message - head.size() - 1;
+            auto const result = std::format_to_n(buffer + head.size(), static_cast<std::ptrdiff_t>(room), fmt, std::forward<TArgs>(args)...);
+            bool const keep = level >= LogLevel::error;
+            if (static_cast<size_t>(result.size) > room) {
+                std::string text(head);
+                std::vformat_to(std::back_inserter(text), fmt.get(), std::make_format_args(args...));
+                text += '\n';
+                return push(text, keep);
+            }
+            size_t const length = head.size() + static_cast<size_t>(result.size);
+            buffer[length] = '\n';
+            return push(std::string_view(buffer, length + 1), keep);
+        }
+
+        /**
+         * @brief Writes everything queued so far before returning.
+         */
+        void flush() noexcept { drain(); }
+
+        /**
+         * @brief Messages dropped because a ring was full.
+         */
+        uint64_t dropped() noexcept {
+            std::lock_guard lock(drain_mutex_);
+            return reported_dropped_;
+        }
+    };
+
+} // namespace mz
+
+#define MZ_LOG(Level, ...) do { \
+    if constexpr (static_cast<int>(Level) >= MZ_LOG_LEVEL) { \
+        if (mz::Logger::instance().enabled(Level)) mz::Logger::instance().log(Level, __VA_ARGS__); \
+    } } while (0)
+
+#define MZ_LOG_TRACE(...) MZ_LOG(mz::LogLevel::trace, __VA_ARGS__)
+#define MZ_LOG_DEBUG(...) MZ_LOG(mz::LogLevel::debug, __VA_ARGS__)
+#define MZ_LOG_INFO(...)  MZ_LOG(mz::LogLevel::info, __VA_ARGS__)
+#define MZ_LOG_WARN(...)  MZ_LOG(mz::LogLevel::warn, __VA_ARGS__)
+#define MZ_LOG_ERROR(...) MZ_LOG(mz::LogLevel::error, __VA_ARGS__)
+
+#endif // MZ_LOG_HEADER_FILE
@@ -0,0 +1,653 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_MMAP_HEADER_FILE
+#define MZ_MMAP_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <string>
+#include "globals.h"
+#include "zstream.h"
+#include "Span.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * @file zmmap.h
+ * @brief Memory-mapped file streams for the mz library.
+ *
+ * This header defines:
+ *   - mz::MmapAdvice: access pattern hints forwarded to the kernel (madvise).
+ *   - mz::MmapStream: read-only mz::Stream over a mapped file with zero-copy Span views.
+ *   - mz::MmapSync: write-back policy for mapped output.
+ *   - mz::MmapWriteStream: growable mz::Stream writing into a mapped file.
+ *
+ * A mapped stream pages data in lazily, so opening a multi-gigabyte file is O(1) and
+ * read_span<T>() hands out views into the page cache instead of copying into a Vector.
+ *
+ * Usage example:
+ *   mz::MmapStream ms("model.bin");
+ *   ms.advise(mz::MmapAdvice::sequential);
+ *   mz::Span<const double> weights = ms.read_vector_span<double>();
+ */
+
+namespace mz {
+
+    /**
+     * @brief Access pattern hints for mapped regions.
+     *
+     * Mirrors the POSIX madvise advice values. On platforms without madvise only
+     * willneed is honoured (as a prefetch); the other hints are ignored.
+     */
+    enum class MmapAdvice : uint8_t { normal, sequential, random, willneed, dontneed };
+
+    /**
+     * @brief Returns the virtual memory page size of the host.
+     */
+    inline size_t page_size() noexcept {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwPageSize);
+#else
+        static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+#endif
+    }
+
+    /**
+     * @brief Forwards an access hint for [address, address + length) to the kernel.
+     *
+     * The start address is rounded down to a page boundary as madvise requires.
+     */
+    inline void advise_memory(const char* address, size_t length, MmapAdvice advice) noexcept {
+        if (!address || !length) return;
+        size_t const page = page_size();
+        uintptr_t const first = reinterpret_cast<uintptr_t>(address) & ~(uintptr_t(page) - 1);
+        length += reinterpret_cast<uintptr_t>(address) - first;
+#if defined(_WIN32)
+        if (advice == MmapAdvice::willneed) {
+            WIN32_MEMORY_RANGE_ENTRY range{ reinterpret_cast<void*>(first), length };
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+        }
+#else
+        int flag = MADV_NORMAL;
+        switch (advice) {
+        case MmapAdvice::sequential: flag = MADV_SEQUENTIAL; break;
+        case MmapAdvice::random: flag = MADV_RANDOM; break;
+        case MmapAdvice::willneed: flag = MADV_WILLNEED; break;
+        case MmapAdvice::dontneed: flag = MADV_DONTNEED; break;
+        default: break;
+        }
+        madvise(reinterpret_cast<void*>(first), length, flag);
+#endif
+    }
+
+    /**
+     * @brief Read-only stream over a memory-mapped file.
+     *
+     * Implements mz::Stream so existing load() code works unchanged: read() copies out of
+     * the mapping with memcpy instead of going through std::fstream. In addition,
+     * read_span<T>() returns a Span<const T> pointing directly into the mapping, which
+     * stays valid until the stream is closed or destroyed.
+     *
+     * Writes are ignored, since the mapping is read-only.
+     *
+     * Usage:
+     *   mz::MmapStream ms("data.bin");
+     *   mz::Vector<int> ids; ids.load(ms);                  // copying load
+     *   auto values = ms.read_vector_span<double>();         // zero-copy view
+     */
+    class MmapStream final : public Stream {
+        std::string file_name_;
+        char* data_{ nullptr };     // Start of the mapping (nullptr for empty files)
+        size_t size_{ 0 };          // Mapped length in bytes
+        size_t position_{ 0 };      // Read cursor
+        bool open_{ false };
+        bool failed_{ false };      // A read ran past the end of the mapping
+        mutable MemoryStreamBuffer buffer_;
+
+#if defined(_WIN32)
+        HANDLE file_{ INVALID_HANDLE_VALUE };
+        HANDLE mapping_{ nullptr };
+#endif
+
+        void read_bytes(char* ptr, arg_type size) noexcept override final {
+            size_t count = static_cast<size_t>(size);
+            count = count < size_ - position_ ? count : size_ - position_;
+            if (count) memcpy(ptr, data_ + position_, count);
+            position_ += count;
+            if (count < static_cast<size_t>(size)) {
+                memset(ptr + count, 0, static_cast<size_t>(size) - count);
+                failed_ = true;
+            }
+        }
+
+        void write_bytes(const char* /*ptr*/, arg_type /*size*/) noexcept override final {}
+
+        void unmap() noexcept {
+#if defined(_WIN32)
+            if (data_) UnmapViewOfFile(data_);
+            if (mapping_) CloseHandle(mapping_);
+            if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+            mapping_ = nullptr;
+            file_ = INVALID_HANDLE_VALUE;
+#else
+            if (data_) munmap(data_, size_);
+#endif
+            data_ = nullptr;
+            size_ = 0;
+            position_ = 0;
+            open_ = false;
+            failed_ = false;
+        }
+
+    public:
+        void flush() noexcept override final {}
+        void end() override final { position_ = size_; }
+        void begin() override final { position_ = 0; failed_ = false; }
+        void close() override final { unmap(); file_name_.clear(); }
+        bool is_file() const noexcept override final { return true; }
+        bool is_open() const noexcept override final { return open_; }
+        bool empty() noexcept override final { return position_ >= size_; }
+        MmapStream& clear() noexcept override final { position_ = 0; failed_ = false; return *this; }
+        MmapStream& operator=(const Stream& /*rhs*/) noexcept override final { return *this; }
+        MmapStream& operator<<(const Stream& /*rhs*/) noexcept override final { return *this; }
+        std::streambuf* rdbuf() const noexcept override final {
+            buffer_.assign(data_, data_ + position_, data_ + size_);
+            return &buffer_;
+        }
+
+        MmapStream() = default;
+        MmapStream(std::string name) { open(std::move(name)); }
+        ~MmapStream() { unmap(); }
+
+        MmapStream(MmapStream const&) = delete;
+        MmapStream& operator=(MmapStream const&) = delete;
+
+        /**
+         * @brief Maps a file for reading. Throws std::domain_error if it cannot be mapped.
+         * @param name File name to open.
+         */
+        void open(std::string name) {
+            ASSERT_IF(!open_, "Cannot map {}. Stream is still mapping {}\n", name, file_name_);
+#if defined(_WIN32)
+            file_ = CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            DOMAIN_ERROR_IF(file_ == INVALID_HANDLE_VALUE, "Error could not open {}", name);
+            LARGE_INTEGER length;
+            GetFileSizeEx(file_, &length);
+            size_ = static_cast<size_t>(length.QuadPart);
+            if (size_) {
+                mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                data_ = mapping_ ? static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+                if (!data_) { unmap(); DOMAIN_ERROR_IF(true, "Error could not map {}", name); }
+            }
+#else
+            int fd = ::open(name.c_str(), O_RDONLY);
+            DOMAIN_ERROR_IF(fd < 0, "Error could not open {}", name);
+            struct stat info;
+            if (fstat(fd, &info) != 0) { ::close(fd); DOMAIN_ERROR_IF(true, "Error could not stat {}", name); }
+            size_ = static_cast<size_t>(info.st_size);
+            if (size_) {
+                void* ptr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if (ptr == MAP_FAILED) { size_ = 0; DOMAIN_ERROR_IF(true, "Error could not map {}", name); }
+                data_ = static_cast<char*>(ptr);
+            }
+            else {
+                ::close(fd);
+            }
+#endif
+            position_ = 0;
+            open_ = true;
+            failed_ = false;
+            file_name_ = std::move(name);
+        }
+
+        /**
+         * @brief Maps the named file (same as open, for parity with StringStream::load).
+         */
+        void load(const char* name) override final { open(name); }
+
+        /**
+         * @brief Writes the whole mapped content to another file.
+         */
+        void save(const char* fname) override final {
+            std::fstream f(fname, std::ios::out | std::ios::binary);
+            if (f.is_open()) f.write(data_, static_cast<std::streamsize>(size_));
+            else DOMAIN_ERROR_IF(true, "Error cannot save {}", fname);
+        }
+
+        // --- Position and Size ---
+
+        /**
+         * @brief Returns the mapped file size in bytes.
+         */
+        size_t size() const noexcept { return size_; }
+
+        /**
+         * @brief Returns the current read offset in bytes.
+         */
+        size_t position() const noexcept { return position_; }
+
+        /**
+         * @brief Returns the number of unread bytes.
+         */
+        size_t remaining() const noexcept { return size_ - position_; }
+
+        /**
+         * @brief Moves the read cursor to an absolute byte offset (clamped to the file size).
+         * @return false if the offset was negative or past the end of the file.
+         */
+        bool seek(int64_t offset) noexcept override final {
+            failed_ = false;
+            position_ = offset < 0 ? 0 : std::min(static_cast<size_t>(offset), size_);
+            return offset >= 0 && static_cast<size_t>(offset) <= size_;
+        }
+        int64_t tell() noexcept override final { return static_cast<int64_t>(position_); }
+
+        /**
+         * @brief Returns true if a read ran past the end of the file (the missing bytes read as zero).
+         *
+         * Cleared by seek, begin, clear and open.
+         */
+        bool failed() const noexcept override final { return failed_; }
+
+        /**
+         * @brief Advances the read cursor without copying.
+         */
+        void skip(size_t count) noexcept { seek(position_ + count); }
+
+        /**
+         * @brief Returns the whole mapping as a byte span (std::span, since mappings may pass 2 GiB).
+         */
+        std::span<const char> bytes() const noexcept { return std::span<const char>(data_, size_); }
+
+        // --- Access Hints ---
+
+        /**
+         * @brief Applies an access hint to the whole mapping.
+         */
+        void advise(MmapAdvice advice) const noexcept { advise_memory(data_, size_, advice); }
+
+        /**
+         * @brief Applies an access hint to [offset, offset + length) of the mapping.
+         */
+        void advise(size_t offset, size_t length, MmapAdvice advice) const noexcept {
+            if (offset >= size_) return;
+            length = length < size_ - offset ? length : size_ - offset;
+            advise_memory(data_ + offset, length, advice);
+        }
+
+        // --- Zero-copy Views ---
+
+        /**
+         * @brief Returns a view of the next count elements and advances past them.
+         *
+         * The view points into the mapping, so no bytes are copied and pages are
+         * faulted in only when touched. The current offset must be aligned for T.
+         * @throws std::domain_error if the file is too short or the offset is misaligned.
+         */
+        template <typename T>
+            requires(std::is_trivially_copyable_v<T>)
+        Span<const T> read_span(size_type count) {
+            size_t const length = sizeof(T) * static_cast<size_t>(count);
+            DOMAIN_ERROR_IF(count < 0 || length > size_ - position_, "MmapStream::read_span({}) overflows {} remaining bytes", count, size_ - position_);
+            const char* ptr = data_ + position_;
+            DOMAIN_ERROR_IF(reinterpret_cast<uintptr_t>(ptr) % alignof(T), "MmapStream::read_span offset {} is not aligned to {}", position_, alignof(T));
+            position_ += length;
+            return Span<const T>(reinterpret_cast<const T*>(ptr), count);
+        }
+
+        /**
+         * @brief Zero-copy counterpart of Vector<T>::load for contiguous element types.
+         *
+         * Reads the size header written by Vector::save and returns a view of the elements.
+         */
+        template <typename T>
+            requires(std::is_trivially_copyable_v<T>)
+        Span<const T> read_vector_span() {
+            size_type count{ 0 };
+            read(count);
+            return read_span<T>(count);
+        }
+    };
+
+    /**
+     * @brief Durability policy for MmapWriteStream.
+     *
+     * none:     leave write-back entirely to the kernel.
+     * on_close: msync the written range synchronously in close().
+     * periodic: start asynchronous write-back every sync interval bytes, plus on_close.
+     */
+    enum class MmapSync : uint8_t { none, on_close, periodic };
+
+    /**
+     * @brief Write stream over a memory-mapped file.
+     *
+     * Writes are plain memcpy calls into the page cache. The file is preallocated
+     * (fallocate/ftruncate) and the mapping grows geometrically (mremap on Linux) when
+     * a write runs past the current capacity. close() truncates the file to the number
+     * of bytes actually written.
+     *
+     * The stream keeps a single cursor: begin() rewinds it so the written bytes can be
+     * read back, and writing after a rewind overwrites in place.
+     *
+     * Usage:
+     *   mz::MmapWriteStream ws("checkpoint.bin", mz::MmapSync::on_close);
+     *   values.save(ws);
+     *   ws.close();
+     */
+    class MmapWriteStream final : public Stream {
+        std::string file_name_;
+        char* data_{ nullptr };     // Start of the mapping
+        size_t capacity_{ 0 };      // Mapped and preallocated bytes
+        size_t size_{ 0 };          // Bytes written so far (high-water mark)
+        size_t position_{ 0 };      // Read/write cursor
+        size_t synced_{ 0 };        // Bytes already handed to periodic write-back
+        size_t sync_interval_{ size_t{ 64 } << 20 };
+        MmapSync sync_{ MmapSync::on_close };
+        bool open_{ false };
+        bool failed_{ false };
+        mutable MemoryStreamBuffer buffer_;
+
+#if defined(_WIN32)
+        HANDLE file_{ INVALID_HANDLE_VALUE };
+        HANDLE mapping_{ nullptr };
+#else
+        int fd_{ -1 };
+#endif
+
+        void read_bytes(char* ptr, arg_type size) noexcept override final {
+            size_t count = static_cast<size_t>(size);
+            count = count < size_ - position_ ? count : size_ - position_;
+            if (count) memcpy(ptr, data_ + position_, count);
+            position_ += count;
+            if (count < static_cast<size_t>(size)) {
+                memset(ptr + count, 0, static_cast<size_t>(size) - count);
+                failed_ = true;
+            }
+        }
+
+        void write_bytes(const char* ptr, arg_type size) noexcept override final {
+            size_t const count = static_cast<size_t>(size);
+            if (position_ + count > capacity_ && !grow(position_ + count)) { failed_ = true; return; }
+            memcpy(data_ + position_, ptr, count);
+            position_ += count;
+            if (position_ > size_) size_ = position_;
+            if (sync_ == MmapSync::periodic && size_ - synced_ >= sync_interval_) {
+                sync_range(synced_, size_, false);
+                synced_ = size_;
+            }
+        }
+
+        /**
+         * @brief Sets the on-disk file length, allocating blocks where the platform allows.
+         */
+        bool resize_file(size_t length, bool allocate) noexcept {
+#if defined(_WIN32)
+            (void)allocate;
+            LARGE_INTEGER offset;
+            offset.QuadPart = static_cast<LONGLONG>(length);
+            return SetFilePointerEx(file_, offset, nullptr, FILE_BEGIN) && SetEndOfFile(file_);
+#else
+#if defined(__linux__)
+            if (allocate && posix_fallocate(fd_, 0, static_cast<off_t>(length)) == 0) return true;
+#else
+            (void)allocate;
+#endif
+            return ftruncate(fd_, static_cast<off_t>(length)) == 0;
+#endif
+        }
+
+        /**
+         * @brief Maps (or remaps) the first capacity bytes of the file.
+         */
+        bool remap(size_t capacity) noexcept {
+#if defined(_WIN32)
+            if (data_) UnmapViewOfFile(data_);
+            if (mapping_) CloseHandle(mapping_);
+            data_ = nullptr;
+            LARGE_INTEGER length;
+            length.QuadPart = static_cast<LONGLONG>(capacity);
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READWRITE, length.HighPart, length.LowPart, nullptr);
+            data_ = mapping_ ? static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, 0)) : nullptr;
+            capacity_ = data_ ? capacity : 0;
+            return data_ != nullptr;
+#else
+#if defined(__linux__)
+            void* ptr = data_ ? mremap(data_, capacity_, capacity, MREMAP_MAYMOVE)
+                : mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (ptr == MAP_FAILED) return false; // the old mapping is still valid
+#else
+            if (data_) munmap(data_, capacity_);
+            data_ = nullptr;
+            capacity_ = 0;
+            void* ptr = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (ptr == MAP_FAILED) return false;
+#endif
+            data_ = static_cast<char*>(ptr);
+            capacity_ = capacity;
+            return true;
+#endif
+        }
+
+        /**
+         * @brief Grows the file and the mapping to hold at least required bytes (doubling).
+         */
+        bool grow(size_t required) noexcept {
+            if (!open_) return false;
+            size_t const page = page_size();
+            size_t capacity = capacity_ * 2 > required ? capacity_ * 2 : required;
+            capacity = (capacity + page - 1) / page * page;
+            return resize_file(capacity, true) && remap(capacity);
+        }
+
+        /**
+         * @brief Starts (or waits for) write-back of [first, last) of the mapping.
+         */
+        void sync_range(size_t first, size_t last, bool blocking) noexcept {
+            if (!data_ || first >= last) return;
+            size_t const aligned = first / page_size() * page_size();
+#if defined(_WIN32)
+            FlushViewOfFile(data_ + aligned, last - aligned);
+            if (blocking) FlushFileBuffers(file_);
+#else
+            msync(data_ + aligned, last - aligned, blocking ? MS_SYNC : MS_ASYNC);
+#endif
+        }
+
+        void release() noexcept {
+            if (!open_) return;
+            if (sync_ != MmapSync::none) sync_range(0, size_, true);
+#if defined(_WIN32)
+            if (data_) UnmapViewOfFile(data_);
+            if (mapping_) CloseHandle(mapping_);
+            data_ = nullptr;
+            mapping_ = nullptr;
+            resize_file(size_, false);
+            CloseHandle(file_);
+            file_ = INVALID_HANDLE_VALUE;
+#else
+            if (data_) munmap(data_, capacity_);
+            data_ = nullptr;
+            resize_file(size_, false);
+            ::close(fd_);
+            fd_ = -1;
+#endif
+            capacity_ = size_ = position_ = synced_ = 0;
+            open_ = false;
+        }
+
+    public:
+        void flush() noexcept override final { if (sync_ != MmapSync::none) sync_range(0, size_, false); }
+        void end() override final { position_ = size_; }
+        void begin() override final { position_ = 0; }
+        void close() override final { release(); file_name_.clear(); }
+        bool is_file() const noexcept override final { return true; }
+        bool is_open() const noexcept override final { return open_; }
+        bool empty() noexcept override final { return position_ >= size_; }
+        MmapWriteStream& clear() noexcept override final { size_ = position_ = synced_ = 0; return *this; }
+        MmapWriteStream& operator=(const Stream& rhs) noexcept override final { return clear() << rhs; }
+        MmapWriteStream& operator<<(const Stream& rhs) noexcept override final {
+            if (std::streambuf* source = rhs.rdbuf()) append(*source);
+            return *this;
+        }
+        std::streambuf* rdbuf() const noexcept override final {
+            buffer_.assign(data_, data_ + position_, data_ + size_);
+            return &buffer_;
+        }
+
+        MmapWriteStream() = default;
+        MmapWriteStream(std::string name, MmapSync sync = MmapSync::on_close, size_t capacity = size_t{ 1 } << 20) {
+            open(std::move(name), sync, capacity);
+        }
+        ~MmapWriteStream() { release(); }
+
+        MmapWriteStream(MmapWriteStream const&) = delete;
+        MmapWriteStream& operator=(MmapWriteStream const&) = delete;
+
+        /**
+         * @brief Creates (or truncates) a file and maps capacity preallocated bytes of it.
+         * @throws std::domain_error if the file cannot be created or mapped.
+         */
+        void open(std::string name, MmapSync sync = MmapSync::on_close, size_t capacity = size_t{ 1 } << 20) {
+            ASSERT_IF(!open_, "Cannot map {}. Stream is still mapping {}\n", name, file_name_);
+            size_t const page = page_size();
+            capacity = capacity > page ? (capacity + page - 1) / page * page : page;
+#if defined(_WIN32)
+            file_ = CreateFileA(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            DOMAIN_ERROR_IF(file_ == INVALID_HANDLE_VALUE, "Error could not create {}", name);
+#else
+            fd_ = ::open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            DOMAIN_ERROR_IF(fd_ < 0, "Error could not create {}", name);
+#endif
+            open_ = true;
+            sync_ = sync;
+            failed_ = false;
+            if (!resize_file(capacity, true) || !remap(capacity)) {
+                release();
+                DOMAIN_ERROR_IF(true, "Error could not map {} bytes of {}", capacity, name);
+            }
+            file_name_ = std::move(name);
+        }
+
+        /**
+         * @brief Appends the content of a file to the stream.
+         */
+        void load(const char* fname) override final {
+            std::fstream f(fname, std::ios::in | std::ios::binary);
+            if (f.is_open()) append(*f.rdbuf());
+            else DOMAIN_ERROR_IF(true, "Error cannot load {}", fname);
+        }
+
+        /**
+         * @brief Copies the written bytes to another file.
+         */
+        void save(const char* fname) override final {
+            std::fstream f(fname, std::ios::out | std::ios::binary);
+            if (f.is_open()) f.write(data_, static_cast<std::streamsize>(size_));
+            else DOMAIN_ERROR_IF(true, "Error cannot save {}", fname);
+        }
+
+        /**
+         * @brief Appends everything readable from a streambuf at the cursor.
+         */
+        void append(std::streambuf& source) noexcept {
+            char chunk[1 << 14];
+            for (std::streamsize n; (n = source.sgetn(chunk, sizeof(chunk))) > 0; ) {
+                write_bytes(chunk, static_cast<arg_type>(n));
+            }
+        }
+
+        // --- Size, Position and Policy ---
+
+        /**
+         * @brief Returns the number of bytes written (the final file size).
+         */
+        size_t size() const noexcept { return size_; }
+
+        /**
+         * @brief Returns the mapped and preallocated capacity in bytes.
+         */
+        size_t capacity() const noexcept { return capacity_; }
+
+        /**
+         * @brief Returns the cursor offset in bytes.
+         */
+        size_t position() const noexcept { return position_; }
+
+        /**
+         * @brief Moves the cursor to an absolute offset (clamped to the written size).
+         * @return false if the offset was negative or past the written size.
+         */
+        bool seek(int64_t offset) noexcept override final {
+            position_ = offset < 0 ? 0 : std::min(static_cast<size_t>(offset), size_);
+            return offset >= 0 && static_cast<size_t>(offset) <= size_;
+        }
+        int64_t tell() noexcept override final { return static_cast<int64_t>(position_); }
+        int64_t write_position() noexcept override final { return static_cast<int64_t>(position_); }
+        bool overwrite(int64_t offset, const char* ptr, arg_type size) noexcept override final {
+            if (offset < 0 || size < 0 || static_cast<size_t>(offset) + static_cast<size_t>(size) > size_) return false;
+            memcpy(data_ + offset, ptr, static_cast<size_t>(size));
+            return true;
+        }
+
+        /**
+         * @brief Returns true if a write was dropped because the mapping could not grow, or a
+         *        read ran past the written bytes (the missing bytes read as zero).
+         */
+        bool failed() const noexcept override final { return failed_; }
+
+        /**
+         * @brief Preallocates capacity bytes up front to avoid growth during writing.
+         */
+        bool reserve(size_t capacity) noexcept { return capacity <= capacity_ || grow(capacity); }
+
+        /**
+         * @brief Sets the byte interval between asynchronous syncs for MmapSync::periodic.
+         */
+        void set_sync_interval(size_t bytes) noexcept { sync_interval_ = bytes ? bytes : 1; }
+
+        /**
+         * @brief Returns the written bytes as a span (std::span, since the file may pass 2 GiB).
+         */
+        std::span<const char> bytes() const noexcept { return std::span<const char>(data_, size_); }
+    };
+
+} // namespace mz
+
+#endif // MZ_MMAP_HEADER_FILE
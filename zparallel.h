@@ -0,0 +1,247 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_PARALLEL_IO_HEADER_FILE
+#define MZ_PARALLEL_IO_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include "globals.h"
+#include "zstream.h"
+#include "zcompress.h"
+#include "thread_utils.h"
+#include "Vector.h"
+#include "BufferStream.h"
+
+/**
+ * @file zparallel.h
+ * @brief Parallel chunked save/load of large Vectors with per-element saver/loader callbacks.
+ *
+ * This header defines:
+ *   - mz::ParallelChunkOptions: chunk size, optional LZ compression and the pool to use.
+ *   - mz::save_parallel / mz::load_parallel: chunked counterparts of save3/load3.
+ *
+ * The vector is split into chunks of chunk_elements elements. Each chunk is serialized into
+ * its own BufferStream on the pool (and optionally compressed with mz::lz), then the
+ * chunks are written in order. Every chunk is preceded by its chunk table entry (element,
+ * raw and stored byte counts), so load reads a batch of chunks sequentially and decodes the
+ * batch in parallel without seeking. Memory stays bounded by one batch of chunks.
+ * A chunk whose serialized size would pass 1 GiB is cut at the element boundary before that
+ * point and continues in a new chunk, so chunk_elements is an upper bound.
+ * The saver and loader run concurrently on pool threads, each on distinct elements.
+ *
+ * Layout: label | "MZPCHNK2" | size_type size | size_type chunk_elements | u32 compressed
+ *         | per chunk: u64 elements | u64 raw bytes | u64 stored bytes | payload | label
+ *
+ * Usage example:
+ *   mz::save_parallel(fs, polygons, [](mz::Stream& s, const Polygon& p) { p.save(s); },
+ *                     { .compress = true }, PolygonsLabel);
+ *   if (mz::load_parallel(fs, polygons, [](mz::Stream& s, Polygon& p) { return p.load3(s); },
+ *                         {}, PolygonsLabel)) { ... }
+ */
+
+namespace mz {
+
+    /**
+     * @brief Options for save_parallel/load_parallel (load only uses pool).
+     */
+    struct ParallelChunkOptions {
+        size_type chunk_elements = size_type{ 1 } << 16;
+        bool compress = false;
+        ThreadPool* pool = nullptr;              // nullptr selects ThreadPool::shared()
+    };
+
+    namespace parallel_detail {
+
+        inline constexpr uint64_t magic = 0x324B4E4843505A4Dull; // "MZPCHNK2"
+        inline constexpr uint64_t max_chunk_bytes = uint64_t{ 1 } << 30;
+
+        inline ThreadPool& pool(const ParallelChunkOptions& options) noexcept {
+            return options.pool ? *options.pool : ThreadPool::shared();
+        }
+
+        // Compresses bytes into packed when that saves space; packed is left empty otherwise
+        inline void pack(Span<const char> bytes, Vector<char>& packed, bool compress) noexcept {
+            packed.clear();
+            if (!compress) return;
+            packed.resize(lz::max_compressed_size(bytes.size()), false);
+            packed.resize(lz::compress(bytes.data(), bytes.size(), packed.data()), true);
+            if (packed.size() >= bytes.size()) packed.clear(); // store raw
+        }
+
+        // Leading piece of a chunk that was cut because it grew past max_chunk_bytes
+        struct Piece {
+            size_type elements = 0;
+            uint64_t raw_bytes = 0;
+            Vector<char> payload;
+        };
+
+        inline void write_chunk(Stream& s, size_type elements, uint64_t raw_bytes, Span<const char> payload) noexcept {
+            s << uint64_t(elements) << raw_bytes << uint64_t(payload.size());
+            s.write(payload.data(), payload.size());
+        }
+
+    } // namespace parallel_detail
+
+    /**
+     * @brief Saves vec in parallel chunks; saver(Stream&, const T&) writes one element.
+     * @return true if a single element serializes to more than 1 GiB; the section is then incomplete.
+     */
+    template <typename T, typename Saver>
+        requires requires(mz::Stream& s, const T& x, Saver&& f) { f(s, x); }
+    bool save_parallel(Stream& s, const Vector<T>& vec, Saver&& saver, const ParallelChunkOptions& options = {}, uint64_t Enc = 0) noexcept {
+        ThreadPool& pool = parallel_detail::pool(options);
+        size_type const size = vec.size();
+        size_type const per = std::max<size_type>(options.chunk_elements, 1);
+        size_t const chunks = (static_cast<size_t>(size) + per - 1) / per;
+        size_t const batch = 2 * pool.size();
+
+        s.write_label(Enc);
+        s << parallel_detail::magic << size << per << uint32_t{ options.compress };
+
+        std::vector<BufferStream> raw(batch);
+        std::vector<Vector<char>> packed(batch);
+        std::vector<size_type> elements(batch);
+        std::vector<std::vector<parallel_detail::Piece>> pieces(batch);
+        std::atomic<bool> oversize{ false };
+        for (size_t first = 0; first < chunks; first += batch) {
+            size_t const count = std::min(batch, chunks - first);
+            pool.parallel_for(count, [&](size_t i) {
+                size_type const begin = static_cast<size_type>((first + i) * per);
+                size_type const end = std::min(size, begin + per);
+                raw[i].reset();
+                pieces[i].clear();
+                elements[i] = 0;
+                for (size_type k = begin; k < end && !oversize.load(std::memory_order_relaxed); k++) {
+                    size_type const mark = raw[i].size();
+                    saver(raw[i], vec[k]);
+                    if (static_cast<uint64_t>(raw[i].size()) > parallel_detail::max_chunk_bytes && mark > 0 && !raw[i].failed()) {
+                        // cut before element k, which then starts the next piece
+                        Vector<char> bytes = raw[i].release();
+                        raw[i].write(bytes.data() + mark, bytes.size() - mark);
+                        bytes.resize(mark, true);
+                        auto& piece = pieces[i].emplace_back();
+                        piece.elements = elements[i];
+                        piece.raw_bytes = static_cast<uint64_t>(mark);
+                        parallel_detail::pack(Span<const char>(bytes.data(), bytes.size()), piece.payload, options.compress);
+                        if (piece.payload.empty()) piece.payload = std::move(bytes);
+                        elements[i] = 0;
+                    }
+                    if (raw[i].failed() || static_cast<uint64_t>(raw[i].size()) > parallel_detail::max_chunk_bytes) {
+                        oversize.store(true);
+                        return;
+                    }
+                    elements[i]++;
+                }
+                parallel_detail::pack(raw[i].view(), packed[i], options.compress);
+            });
+            if (oversize.load()) return true;
+            for (size_t i = 0; i < count; i++) {
+                for (auto const& piece : pieces[i]) {
+                    parallel_detail::write_chunk(s, piece.elements, piece.raw_bytes, Span<const char>(piece.payload.data(), piece.payload.size()));
+                }
+                Span<const char> const payload = packed[i].empty() ? raw[i].view() : Span<const char>(packed[i].data(), packed[i].size());
+                parallel_detail::write_chunk(s, elements[i], static_cast<uint64_t>(raw[i].size()), payload);
+            }
+        }
+        s.write_label(Enc);
+        return false;
+    }
+
+    /**
+     * @brief Saves vec in parallel chunks with the element's own Stream operator<<.
+     */
+    template <typename T>
+        requires requires(mz::Stream& s, const T& x) { s << x; }
+    bool save_parallel(Stream& s, const Vector<T>& vec, const ParallelChunkOptions& options = {}, uint64_t Enc = 0) noexcept {
+        return save_parallel(s, vec, [](Stream& ss, const T& x) { ss << x; }, options, Enc);
+    }
+
+    /**
+     * @brief Loads a vector written by save_parallel; loader(Stream&, T&) returns true on error.
+     * @return true on error (label mismatch, corrupt chunk or a failing loader), false on success.
+     */
+    template <typename T, typename Loader>
+        requires requires(mz::Stream& s, T& x, Loader&& f) { { f(s, x) } -> std::same_as<bool>; }
+    bool load_parallel(Stream& s, Vector<T>& vec, Loader&& loader, const ParallelChunkOptions& options = {}, uint64_t Enc = 0) noexcept {
+        if (s.read_label(Enc)) return true;
+        uint64_t magic{ 0 };
+        size_type size{ -1 }, per{ 0 };
+        uint32_t compressed{ 0 };
+        s >> magic >> size >> per >> compressed;
+        if (s.failed() || magic != parallel_detail::magic || size < 0 || per <= 0) return true;
+
+        ThreadPool& pool = parallel_detail::pool(options);
+        size_t const batch = 2 * pool.size();
+        vec.resize(size, false);
+
+        std::vector<Vector<char>> raw(batch), packed(batch);
+        std::vector<uint64_t> raw_bytes(batch);
+        std::vector<size_type> begins(batch + 1);
+        std::atomic<bool> failed{ false };
+        for (size_type loaded = 0; loaded < size && !failed.load(); ) {
+            size_t count = 0;
+            for (; count < batch && loaded < size; count++) {
+                uint64_t elements{ 0 }, stored{ UINT64_MAX };
+                s >> elements >> raw_bytes[count] >> stored;
+                if (s.failed() || elements == 0 || elements > static_cast<uint64_t>(size - loaded)) return true;
+                if (raw_bytes[count] > parallel_detail::max_chunk_bytes || stored > raw_bytes[count]) return true;
+                begins[count] = loaded;
+                loaded += static_cast<size_type>(elements);
+                packed[count].resize(stored, false);
+                s.read(packed[count].data(), static_cast<int>(stored));
+                if (s.failed()) return true;
+            }
+            begins[count] = loaded;
+            pool.parallel_for(count, [&](size_t i) {
+                Vector<char>& payload = packed[i].size() == static_cast<size_type>(raw_bytes[i]) ? packed[i] : raw[i];
+                if (&payload == &raw[i]) {
+                    raw[i].resize(raw_bytes[i], false);
+                    if (!lz::decompress(packed[i].data(), packed[i].size(), raw[i].data(), raw[i].size())) { failed.store(true); return; }
+                }
+                BufferStream ss(std::move(payload));   // adopt, no copy
+                for (size_type k = begins[i]; k < begins[i + 1] && !failed.load(); k++) {
+                    if (loader(ss, vec[k])) failed.store(true);
+                }
+                if (ss.failed() || !ss.empty()) failed.store(true);   // short or oversized chunk
+                payload = ss.release();                 // keep the allocation for the next batch
+            });
+        }
+        return failed.load() || s.read_label(Enc);
+    }
+
+    /**
+     * @brief Loads a vector written by save_parallel with the element's own Stream operator>>.
+     */
+    template <typename T>
+        requires requires(mz::Stream& s, T& x) { s >> x; }
+    bool load_parallel(Stream& s, Vector<T>& vec, const ParallelChunkOptions& options = {}, uint64_t Enc = 0) noexcept {
+        return load_parallel(s, vec, [](Stream& ss, T& x) { ss >> x; return ss.failed(); }, options, Enc);
+    }
+
+} // namespace mz
+
+#endif // MZ_PARALLEL_IO_HEADER_FILE
@@ -0,0 +1,319 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef MZ_PERF_HEADER_FILE
+#define MZ_PERF_HEADER_FILE
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <string>
+#include "globals.h"
+#include "timer_utils.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define MZ_PERF_AVAILABLE 1
+#else
+#define MZ_PERF_AVAILABLE 0
+#endif
+
+/**
+ * @file zperf.h
+ * @brief Hardware performance counters (Linux perf_event_open) with a Timer-like interface.
+ *
+ * This header defines:
+ *   - mz::PerfEvent: cycles, instructions, LLC misses, L1D read misses, branch misses,
+ *     dTLB read misses.
+ *   - mz::PerfSample: counter values and wall time of one interval.
+ *   - mz::PerfCounters: opens the events as one counter group (so they are scheduled
+ *     together and ratios such as IPC are consistent), then stamp()/last()/total()
+ *     like Timer, plus ipc() and per-element metrics.
+ *
+ * Only user-space events are counted (exclude_kernel), which perf_event_paranoid = 2 allows.
+ * Events the CPU or kernel do not support are skipped; if no event can be opened (no
+ * permission, a container without PMU access, or not Linux), available() is false,
+ * error() says why, and every counter reads as missing while wall time keeps working.
+ * When the kernel multiplexes the group, values are scaled by time enabled / time running.
+ *
+ * Usage example:
+ *   mz::PerfCounters pc;                     // starts counting
+ *   kernel(v);
+ *   pc.stamp();
+ *   mz::print("{}\n", pc.string(v.size()));  // "1.23 ms  IPC 2.81  cycles/elem 0.98 ..."
+ *   if (pc.last().has(mz::PerfEvent::llc_misses)) ...
+ */
+
+namespace mz {
+
+    enum class PerfEvent : uint8_t { cycles, instructions, llc_misses, l1d_misses, branch_misses, dtlb_misses };
+
+    inline constexpr size_t perf_event_count = 6;
+
+    constexpr const char* perf_event_name(PerfEvent e) noexcept {
+        constexpr const char* names[perf_event_count] = { "cycles", "instructions", "llc-misses", "l1d-misses", "branch-misses", "dtlb-misses" };
+        return names[static_cast<size_t>(e)];
+    }
+
+    /**
+     * @brief Counter values of one interval (or of a total); missing events read as -1.
+     */
+    struct PerfSample {
+        std::array<int64_t, perf_event_count> values{ -1, -1, -1, -1, -1, -1 };
+        int64_t ns = 0;
+
+        bool has(PerfEvent e) const noexcept { return values[static_cast<size_t>(e)] >= 0; }
+        int64_t operator[](PerfEvent e) const noexcept { return values[static_cast<size_t>(e)]; }
+
+        double seconds() const noexcept { return static_cast<double>(ns) * 1e-9; }
+
+        /**
+         * @brief Instructions per cycle; 0 when either counter is missing.
+         */
+        double ipc() const noexcept {
+            return has(PerfEvent::cycles) && has(PerfEvent::instructions) && (*this)[PerfEvent::cycles] > 0
+                ? static_cast<double>((*this)[PerfEvent::instructions]) / static_cast<double>((*this)[PerfEvent::cycles]) : 0.0;
+        }
+
+        /**
+         * @brief Event count divided by @p elements (e.g. misses per element); -1 when missing.
+         */
+        double per(PerfEvent e, double elements) const noexcept {
+            return has(e) && elements > 0 ? static_cast<double>((*this)[e]) / elements : -1.0;
+        }
+
+        PerfSample& operator += (const PerfSample& rhs) noexcept {
+            for (size_t i = 0; i < perf_event_count; i++) {
+                values[i] = values[i] < 0 || rhs.values[i] < 0 ? (rhs.values[i] < 0 ? values[i] : rhs.values[i]) : values[i] + rhs.values[i];
+            }
+            ns += rhs.ns;
+            return *this;
+        }
+
+        /**
+         * @brief "1.234 ms  IPC 2.10  cycles 1234  ..." with each present counter, divided by
+         *        @p elements when it is positive.
+         */
+        std::string string(double elements = 0) const {
+            std::string out = std::format("{:.3f} ms", static_cast<double>(ns) * 1e-6);
+            if (ipc() > 0) out += std::format("  IPC {:.2f}", ipc());
+            for (size_t i = 0; i < perf_event_count; i++) {
+                if (values[i] < 0) continue;
+                PerfEvent const e = static_cast<PerfEvent>(i);
+                if (elements > 0) out += std::format("  {}/elem {:.3f}", perf_event_name(e), per(e, elements));
+                else out += std::format("  {} {}", perf_event_name(e), values[i]);
+            }
+            return out;
+        }
+    };
+
+    class PerfCounters {
+        struct Counter {
+            int fd = -1;
+            PerfEvent event{};
+        };
+
+        std::array<Counter, perf_event_count> counters_{};
+        size_t opened_ = 0;
+        std::string error_;
+
+        // raw (unscaled) values and times at the previous stamp
+        std::array<uint64_t, perf_event_count> previous_{};
+        uint64_t previous_enabled_ = 0;
+        uint64_t previous_running_ = 0;
+
+        SteadyTimer timer_;
+        PerfSample last_;
+        PerfSample total_;
+
+#if MZ_PERF_AVAILABLE
+        static bool config_of(PerfEvent e, perf_event_attr& attr) noexcept {
+            constexpr uint64_t read_miss = PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+            switch (e) {
+            case PerfEvent::cycles:        attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; return true;
+            case PerfEvent::instructions:  attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; return true;
+            case PerfEvent::llc_misses:    attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CACHE_MISSES; return true;
+            case PerfEvent::l1d_misses:    attr.type = PERF_TYPE_HW_CACHE; attr.config = PERF_COUNT_HW_CACHE_L1D | read_miss; return true;
+            case PerfEvent::branch_misses: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; return true;
+            case PerfEvent::dtlb_misses:   attr.type = PERF_TYPE_HW_CACHE; attr.config = PERF_COUNT_HW_CACHE_DTLB | read_miss; return true;
+            }
+            return false;
+        }
+
+        int open_event(PerfEvent e, int group) noexcept {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            if (!config_of(e, attr)) return -1;
+            attr.disabled = group < 0 ? 1 : 0;      // the leader starts the whole group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC));
+        }
+#endif
+
+        // Reads the group; returns false when nothing is open or the read fails
+        bool read_raw(std::array<uint64_t, perf_event_count>& raw, uint64_t& enabled, uint64_t& running) const noexcept {
+#if MZ_PERF_AVAILABLE
+            if (!opened_) return false;
+            uint64_t buffer[3 + perf_event_count]{};
+            ssize_t const n = ::read(counters_[0].fd, buffer, sizeof(buffer));
+            if (n < static_cast<ssize_t>(sizeof(uint64_t) * (3 + opened_)) || buffer[0] != opened_) return false;
+            enabled = buffer[1];
+            running = buffer[2];
+            for (size_t i = 0; i < opened_; i++) raw[i] = buffer[3 + i];
+            return true;
+#else
+            (void)raw; (void)enabled; (void)running;
+            return false;
+#endif
+        }
+
+    public:
+        /**
+         * @brief Opens the requested events as one group and starts counting.
+         */
+        explicit PerfCounters(std::initializer_list<PerfEvent> events = {
+            PerfEvent::cycles, PerfEvent::instructions, PerfEvent::llc_misses,
+            PerfEvent::l1d_misses, PerfEvent::branch_misses, PerfEvent::dtlb_misses }) {
+#if MZ_PERF_AVAILABLE
+            int first_errno{ 0 };
+            for (PerfEvent e : events) {
+                if (opened_ == perf_event_count) break;
+                int const fd = open_event(e, opened_ ? counters_[0].fd : -1);
+                if (fd < 0) { if (!first_errno) first_errno = errno; continue; }
+                counters_[opened_++] = { fd, e };
+            }
+            if (!opened_) {
+                error_ = std::format("perf_event_open failed: {}{}", strerror(first_errno),
+                    first_errno == EACCES || first_errno == EPERM ? " (check /proc/sys/kernel/perf_event_paranoid or CAP_PERFMON)" : "");
+            }
+#else
+            (void)events;
+            error_ = "hardware counters need Linux perf_event_open";
+#endif
+            reset();
+        }
+
+        ~PerfCounters() {
+#if MZ_PERF_AVAILABLE
+            for (size_t i = opened_; i-- > 0;) close(counters_[i].fd);
+#endif
+        }
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        /**
+         * @brief True when at least one hardware counter is open.
+         */
+        bool available() const noexcept { return opened_ > 0; }
+
+        /**
+         * @brief Why no counter could be opened; empty when available().
+         */
+        const std::string& error() const noexcept { return error_; }
+
+        /**
+         * @brief Whether @p e is being counted.
+         */
+        bool counting(PerfEvent e) const noexcept {
+            for (size_t i = 0; i < opened_; i++) if (counters_[i].event == e) return true;
+            return false;
+        }
+
+        /**
+         * @brief Clears last and total, and starts a new interval.
+         */
+        void reset() noexcept {
+#if MZ_PERF_AVAILABLE
+            if (opened_) {
+                ioctl(counters_[0].fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(counters_[0].fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+#endif
+            last_ = {};
+            total_ = {};
+            for (size_t i = 0; i < opened_; i++) total_.values[static_cast<size_t>(counters_[i].event)] = 0;
+            previous_ = {};
+            previous_enabled_ = previous_running_ = 0;
+            read_raw(previous_, previous_enabled_, previous_running_);
+            timer_.reset();
+        }
+
+        /**
+         * @brief Ends the current interval, adds it to the totals and starts the next one.
+         * @return The interval's wall time in seconds, like Timer::stamp().
+         */
+        double stamp() noexcept {
+            std::array<uint64_t, perf_event_count> raw{};
+            uint64_t enabled{ 0 }, running{ 0 };
+            bool const ok = read_raw(raw, enabled, running);
+            timer_.stamp();
+
+            last_ = {};
+            last_.ns = timer_.last_ns();
+            // a group that never got on the PMU during the interval leaves everything missing
+            if (ok && running > previous_running_) {
+                double const scale = static_cast<double>(enabled - previous_enabled_) / static_cast<double>(running - previous_running_);
+                for (size_t i = 0; i < opened_; i++) {
+                    last_.values[static_cast<size_t>(counters_[i].event)] =
+                        static_cast<int64_t>(static_cast<double>(raw[i] - previous_[i]) * scale + 0.5);
+                }
+            }
+            if (ok) {
+                previous_ = raw;
+                previous_enabled_ = enabled;
+                previous_running_ = running;
+            }
+            total_ += last_;
+            return last_.seconds();
+        }
+
+        /**
+         * @brief Counters and wall time of the last stamp() interval.
+         */
+        const PerfSample& last() const noexcept { return last_; }
+
+        /**
+         * @brief Sum of all intervals since construction or reset().
+         */
+        const PerfSample& total() const noexcept { return total_; }
+
+        double ipc() const noexcept { return last_.ipc(); }
+
+        /**
+         * @brief Formatted last() interval, per element when @p elements is positive.
+         */
+        std::string string(double elements = 0) const { return last_.string(elements); }
+    };
+
+} // namespace mz
+
+#endif // MZ_PERF_HEADER_FILE
@@ -0,0 +1,392 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef MZ_PROFILE_HEADER_FILE
+#define MZ_PROFILE_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "globals.h"
+#include "timer_utils.h"
+
+/**
+ * @file zprofile.h
+ * @brief Scoped profiling zones with a call-tree report and Chrome trace export.
+ *
+ * This header defines:
+ *   - MZ_PROFILE_ZONE("name"), MZ_PROFILE_FUNCTION(): RAII zones that time the enclosing
+ *     scope. They expand to nothing unless MZ_PROFILE is defined to a non-zero value.
+ *   - mz::ProfileZone: the zone object behind the macros.
+ *   - mz::ProfileNode: one call-tree entry (count, total and self time).
+ *   - mz::Profiler: owns the per-thread buffers; report(), report_string(), chrome_trace(),
+ *     save_chrome_trace() and clear().
+ *
+ * A zone reads the TSC (TscClock) when it opens and closes, and on close appends one
+ * 32-byte event to its thread's buffer. The buffer is a list of fixed-size chunks written
+ * only by the owning thread, which publishes its size with a release store, so recording
+ * never locks; the profiler mutex is only taken when a thread records its first zone and
+ * when a report is built. A thread keeps at most max_events_per_thread events; later
+ * zones, and all zones of a thread whose buffer could not be allocated, are counted in
+ * dropped(). Buffers outlive their threads, so reports include
+ * threads that have exited. Zone names must be string literals (or otherwise outlive
+ * the report).
+ *
+ * report() merges all threads into one tree keyed by the path of zone names; self time is
+ * the total minus the time of child zones. chrome_trace() writes the events as complete
+ * ("ph":"X") events, which chrome://tracing and ui.perfetto.dev open directly.
+ *
+ * Usage example:
+ *   #define MZ_PROFILE 1
+ *   #include "zprofile.h"
+ *   void step() {
+ *       MZ_PROFILE_FUNCTION();
+ *       { MZ_PROFILE_ZONE("load"); ... }
+ *       { MZ_PROFILE_ZONE("solve"); ... }
+ *   }
+ *   mz::print("{}", mz::Profiler::instance().report_string());
+ *   mz::Profiler::instance().save_chrome_trace("trace.json");
+ */
+
+#ifndef MZ_PROFILE
+#define MZ_PROFILE 0
+#endif
+
+#define MZ_PROFILE_CONCAT_(a, b) a##b
+#define MZ_PROFILE_CONCAT(a, b) MZ_PROFILE_CONCAT_(a, b)
+
+#if MZ_PROFILE
+#define MZ_PROFILE_ZONE(name) ::mz::ProfileZone MZ_PROFILE_CONCAT(mz_profile_zone_, __LINE__)(name)
+#define MZ_PROFILE_FUNCTION() MZ_PROFILE_ZONE(__func__)
+#else
+#define MZ_PROFILE_ZONE(name) ((void)0)
+#define MZ_PROFILE_FUNCTION() ((void)0)
+#endif
+
+namespace mz {
+
+    /**
+     * @brief One entry of the merged call tree, in depth-first order.
+     */
+    struct ProfileNode {
+        std::string name;
+        int depth = 0;          // 0 for top-level zones
+        uint64_t count = 0;
+        int64_t total_ns = 0;
+        int64_t self_ns = 0;    // total minus time spent in child zones
+    };
+
+    class Profiler {
+    public:
+        struct Event {
+            const char* name;
+            uint64_t begin;     // TscClock ticks
+            uint64_t end;
+            uint32_t depth;
+            uint32_t thread;
+        };
+
+        static constexpr size_t chunk_events = 4096;
+
+        struct Chunk {
+            Event events[chunk_events];
+            std::atomic<Chunk*> next{ nullptr };
+        };
+
+        // Written by the owning thread only; readers see [0, size) after an acquire load
+        struct ThreadBuffer {
+            std::unique_ptr<Chunk> head{ new (std::nothrow) Chunk };
+            Chunk* tail = head.get();
+            size_t tail_used = 0;
+            std::atomic<size_t> size{ 0 };
+            std::atomic<uint64_t> dropped{ 0 };
+            uint32_t depth = 0;
+            uint32_t thread = 0;
+
+            ~ThreadBuffer() {
+                Chunk* c = head ? head->next.load(std::memory_order_relaxed) : nullptr;
+                while (c) { Chunk* n = c->next.load(std::memory_order_relaxed); delete c; c = n; }
+            }
+
+            void push(const Event& e, size_t limit) noexcept {
+                size_t const n = size.load(std::memory_order_relaxed);
+                if (n >= limit) { dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); return; }
+                if (tail_used == chunk_events) {
+                    Chunk* c = new (std::nothrow) Chunk;
+                    if (!c) { dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); return; }
+                    tail->next.store(c, std::memory_order_release);
+                    tail = c;
+                    tail_used = 0;
+                }
+                tail->events[tail_used++] = e;
+                size.store(n + 1, std::memory_order_release);
+            }
+
+            template <typename F>
+            void for_each(F&& f) const {
+                size_t n = size.load(std::memory_order_acquire);
+                for (const Chunk* c = head.get(); c && n; c = c->next.load(std::memory_order_acquire)) {
+                    size_t const k = std::min(n, chunk_events);
+                    for (size_t i = 0; i < k; i++) f(c->events[i]);
+                    n -= k;
+                }
+            }
+        };
+
+    private:
+        std::mutex mutex_;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+        std::atomic<size_t> max_events_{ size_t{ 1 } << 20 };
+        std::atomic<uint64_t> unbuffered_{ 0 };  // zones of threads whose buffer could not be allocated
+
+        Profiler() = default;
+
+        // nullptr when out of memory; that thread's zones are then only counted as dropped
+        ThreadBuffer* add_thread() noexcept {
+            std::unique_ptr<ThreadBuffer> buffer(new (std::nothrow) ThreadBuffer);
+            if (!buffer || !buffer->head) return nullptr;
+            std::lock_guard lock(mutex_);
+            try { buffers_.reserve(buffers_.size() + 1); }
+            catch (const std::bad_alloc&) { return nullptr; }
+            buffer->thread = static_cast<uint32_t>(buffers_.size() + 1);
+            buffers_.push_back(std::move(buffer));
+            return buffers_.back().get();
+        }
+
+    public:
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        static Profiler& instance() {
+            static Profiler profiler;
+            return profiler;
+        }
+
+        /**
+         * @brief Buffer of the calling thread, created on first use; nullptr if that allocation failed.
+         */
+        ThreadBuffer* local() noexcept {
+            thread_local ThreadBuffer* buffer = add_thread();
+            return buffer;
+        }
+
+        /**
+         * @brief Counts a zone that had no buffer to go to.
+         */
+        void count_unbuffered() noexcept { unbuffered_.fetch_add(1, std::memory_order_relaxed); }
+
+        /**
+         * @brief Per-thread event limit (default 2^20, 32 MB); applies to later zones.
+         */
+        void set_max_events_per_thread(size_t n) noexcept { max_events_.store(n, std::memory_order_relaxed); }
+        size_t max_events_per_thread() const noexcept { return max_events_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Zones dropped because a thread buffer was full or could not be allocated.
+         */
+        uint64_t dropped() {
+            std::lock_guard lock(mutex_);
+            uint64_t n{ unbuffered_.load(std::memory_order_relaxed) };
+            for (auto& b : buffers_) n += b->dropped.load(std::memory_order_relaxed);
+            return n;
+        }
+
+        /**
+         * @brief Forgets all recorded events. Call it while no zone is open on any thread.
+         */
+        void clear() {
+            std::lock_guard lock(mutex_);
+            unbuffered_.store(0, std::memory_order_relaxed);
+            for (auto& b : buffers_) {
+                b->size.store(0, std::memory_order_relaxed);
+                b->dropped.store(0, std::memory_order_relaxed);
+                b->tail = b->head.get();
+                b->tail_used = 0;
+                Chunk* c = b->head->next.exchange(nullptr, std::memory_order_relaxed);
+                while (c) { Chunk* n = c->next.load(std::memory_order_relaxed); delete c; c = n; }
+            }
+        }
+
+        /**
+         * @brief Copy of all events of all threads, each thread in order of zone start.
+         */
+        std::vector<Event> events() {
+            std::vector<Event> all;
+            std::lock_guard lock(mutex_);
+            for (auto& b : buffers_) {
+                size_t const first = all.size();
+                b->for_each([&](const Event& e) { all.push_back(e); });
+                std::sort(all.begin() + first, all.end(), [](const Event& a, const Event& b) {
+                    return a.begin != b.begin ? a.begin < b.begin : a.depth < b.depth;
+                });
+            }
+            return all;
+        }
+
+        /**
+         * @brief Call tree merged over all threads, depth first, children by total time.
+         */
+        std::vector<ProfileNode> report() {
+            struct Node {
+                const char* name;
+                int parent;
+                uint64_t count = 0;
+                int64_t total = 0;
+                int64_t children = 0;
+                std::vector<int> kids;
+            };
+            std::vector<Node> tree{ { "", -1 } };
+            auto child = [&](int parent, const char* name) {
+                for (int k : tree[parent].kids) {
+                    if (tree[k].name == name || std::string_view(tree[k].name) == name) return k;
+                }
+                tree.push_back({ name, parent });
+                int const k = static_cast<int>(tree.size() - 1);
+                tree[parent].kids.push_back(k);
+                return k;
+            };
+
+            std::vector<Event> all = events();
+            std::vector<int> stack;
+            uint32_t thread{ 0 };
+            for (const Event& e : all) {
+                if (e.thread != thread) { stack.clear(); thread = e.thread; }
+                // parent is the open zone one level up; missing levels (dropped or still open
+                // zones) attach to the deepest known ancestor
+                if (stack.size() > e.depth) stack.resize(e.depth);
+                int const parent = stack.empty() ? 0 : stack.back();
+                int const node = child(parent, e.name);
+                int64_t const ns = TscClock::ticks_to_ns(static_cast<int64_t>(e.end - e.begin));
+                tree[node].count++;
+                tree[node].total += ns;
+                if (parent) tree[parent].children += ns;
+                stack.push_back(node);
+            }
+
+            std::vector<ProfileNode> result;
+            auto visit = [&](auto&& self, int n, int depth) -> void {
+                std::vector<int> kids = tree[n].kids;
+                std::sort(kids.begin(), kids.end(), [&](int a, int b) { return tree[a].total > tree[b].total; });
+                for (int k : kids) {
+                    const Node& t = tree[k];
+                    result.push_back({ t.name, depth, t.count, t.total, t.total - t.children });
+                    self(self, k, depth + 1);
+                }
+            };
+            visit(visit, 0, 0);
+            return result;
+        }
+
+        /**
+         * @brief report() as an indented table with times in milliseconds.
+         */
+        std::string report_string() {
+            std::string out = std::format("{:<40} {:>10} {:>12} {:>12}\n", "zone", "count", "total ms", "self ms");
+            for (const ProfileNode& n : report()) {
+                std::string name(static_cast<size_t>(n.depth) * 2, ' ');
+                name += n.name;
+                out += std::format("{:<40} {:>10} {:>12.3f} {:>12.3f}\n", name, n.count, n.total_ns * 1e-6, n.self_ns * 1e-6);
+            }
+            return out;
+        }
+
+        /**
+         * @brief All events as Chrome trace JSON ("traceEvents" of complete events, times in
+         *        microseconds from the earliest zone).
+         */
+        std::string chrome_trace() {
+            std::vector<Event> all = events();
+            uint64_t origin{ UINT64_MAX };
+            for (const Event& e : all) origin = std::min(origin, e.begin);
+            std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            bool first{ true };
+            for (const Event& e : all) {
+                if (!first) out += ',';
+                first = false;
+                out += "\n{\"name\":\"";
+                for (const char* p = e.name; *p; p++) {
+                    if (*p == '"' || *p == '\\') out += '\\';
+                    if (static_cast<unsigned char>(*p) >= 0x20) out += *p;
+                }
+                double const ts = static_cast<double>(TscClock::ticks_to_ns(static_cast<int64_t>(e.begin - origin))) * 1e-3;
+                double const dur = static_cast<double>(TscClock::ticks_to_ns(static_cast<int64_t>(e.end - e.begin))) * 1e-3;
+                out += std::format("\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", e.thread, ts, dur);
+            }
+            out += "\n]}\n";
+            return out;
+        }
+
+        /**
+         * @brief Writes chrome_trace() to a file.
+         * @return true on error.
+         */
+        bool save_chrome_trace(const char* path) {
+            std::string const json = chrome_trace();
+            FILE* f = std::fopen(path, "wb");
+            if (!f) return true;
+            bool const failed = std::fwrite(json.data(), 1, json.size(), f) != json.size();
+            return std::fclose(f) != 0 || failed;
+        }
+    };
+
+    /**
+     * @brief Times its scope and records it in the calling thread's profiler buffer.
+     *        Normally created through MZ_PROFILE_ZONE.
+     */
+    class ProfileZone {
+        Profiler::ThreadBuffer* buffer_;
+        const char* name_;
+        uint64_t begin_;
+        uint32_t depth_;
+
+    public:
+        explicit ProfileZone(const char* name) noexcept
+            : buffer_(Profiler::instance().local()), name_(name), depth_(buffer_ ? buffer_->depth++ : 0) {
+            begin_ = TscClock::start_ticks();
+        }
+
+        ~ProfileZone() {
+            uint64_t const end = TscClock::stop_ticks();
+            if (!buffer_) {
+                Profiler::instance().count_unbuffered();
+                return;
+            }
+            buffer_->depth--;
+            buffer_->push({ name_, begin_, end, depth_, buffer_->thread }, Profiler::instance().max_events_per_thread());
+        }
+
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+    };
+
+} // namespace mz
+
+#endif // MZ_PROFILE_HEADER_FILE
@@ -31,6 +31,16 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include "thread_utils.h"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 /**
  * @file zstream.h
@@ -74,6 +84,9 @@ namespace mz {
         virtual void read_bytes(char* ptr, arg_type size) noexcept = 0;
         virtual void write_bytes(const char* ptr, arg_type size) noexcept = 0;
 
+        // Largest byte count handed to read_bytes/write_bytes in one call
+        static constexpr size_t max_chunk_bytes = size_t{ 1 } << 30;
+
     public:
         // Stream management and meta operations
         virtual Stream& clear() noexcept = 0;
@@ -90,6 +103,18 @@ namespace mz {
         virtual void load(const char* name) = 0;
         virtual void flush() noexcept = 0;
 
+        // Random access on the read position; streams without it keep these defaults
+        virtual int64_t tell() noexcept { return -1; }
+        virtual bool seek(int64_t /*offset*/) noexcept { return false; }
+
+        // Offset of the next write, and in-place rewrite of bytes already written there or
+        // earlier (cursors unchanged); used to patch headers whose value is known only at the end
+        virtual int64_t write_position() noexcept { return -1; }
+        virtual bool overwrite(int64_t /*offset*/, const char* /*ptr*/, arg_type /*size*/) noexcept { return false; }
+
+        // True once an operation on the stream has failed (for streams that can tell)
+        virtual bool failed() const noexcept { return false; }
+
         // Typed read/write for trivially copyable types
         template <class T>
             requires(std::is_trivially_copyable_v<T>)
@@ -99,13 +124,30 @@ namespace mz {
             requires(std::is_trivially_copyable_v<T>)
         void write(const T& x) noexcept { write_bytes(reinterpret_cast<const char*>(&x), sizeof(T)); }
 
+        // Bulk read/write of count elements, split so each call fits in arg_type
         template <class T>
             requires(std::is_trivially_copyable_v<T>)
-        void read(T* ptr, int count) noexcept { read_bytes(reinterpret_cast<char*>(ptr), sizeof(T) * count); }
+        void read(T* ptr, int count) noexcept {
+            char* bytes = reinterpret_cast<char*>(ptr);
+            for (size_t left = count > 0 ? sizeof(T) * static_cast<size_t>(count) : 0; left; ) {
+                arg_type chunk = static_cast<arg_type>(left < max_chunk_bytes ? left : max_chunk_bytes);
+                read_bytes(bytes, chunk);
+                bytes += chunk;
+                left -= chunk;
+            }
+        }
 
         template <class T>
             requires(std::is_trivially_copyable_v<T>)
-        void write(const T* ptr, int count) noexcept { write_bytes(reinterpret_cast<const char*>(ptr), sizeof(T) * count); }
+        void write(const T* ptr, int count) noexcept {
+            const char* bytes = reinterpret_cast<const char*>(ptr);
+            for (size_t left = count > 0 ? sizeof(T) * static_cast<size_t>(count) : 0; left; ) {
+                arg_type chunk = static_cast<arg_type>(left < max_chunk_bytes ? left : max_chunk_bytes);
+                write_bytes(bytes, chunk);
+                bytes += chunk;
+                left -= chunk;
+            }
+        }
 
         // Virtual destructor
         virtual ~Stream() = 0;
@@ -167,15 +209,80 @@ namespace mz {
         void write_label(uint64_t encoding = 0) noexcept {
             if (encoding) { write(encoding); }
         }
+
+        /**
+         * @brief Writes an unsigned value as a LEB128 varint (1 to 10 bytes).
+         *
+         * Small sizes and counts take one or two bytes instead of a fixed 4 or 8.
+         *
+         * Usage:
+         *   stream.write_varint(vec.size());
+         */
+        void write_varint(uint64_t value) noexcept {
+            char bytes[10];
+            arg_type count{ 0 };
+            while (value >= 0x80) {
+                bytes[count++] = static_cast<char>(static_cast<uint8_t>(value) | 0x80);
+                value >>= 7;
+            }
+            bytes[count++] = static_cast<char>(value);
+            write_bytes(bytes, count);
+        }
+
+        /**
+         * @brief Reads a LEB128 varint written by write_varint.
+         */
+        uint64_t read_varint() noexcept {
+            uint64_t value{ 0 };
+            for (int shift = 0; shift < 64; shift += 7) {
+                uint8_t byte{ 0 };
+                read(byte);
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) break;
+            }
+            return value;
+        }
     };
 
     inline Stream::~Stream() {}
 
+    /**
+     * @brief Non-owning std::streambuf over a contiguous byte range.
+     *
+     * Lets memory-backed streams (e.g. mapped files) answer rdbuf() without copying,
+     * so they can be piped into a FileStream or StringStream with operator<<.
+     *
+     * Usage:
+     *   MemoryStreamBuffer buffer;
+     *   buffer.assign(first, first, last); // get area [first, last), cursor at first
+     */
+    class MemoryStreamBuffer : public std::streambuf {
+    public:
+        void assign(char* first, char* cursor, char* last) noexcept { setg(first, cursor, last); }
+    };
+
+    /**
+     * @brief Tuning for large FileStream reads.
+     *
+     * Reads of at least parallel_threshold bytes bypass std::fstream: disjoint chunk_size
+     * pieces are fetched with pread on the shared ThreadPool. With direct set, chunks are
+     * read with O_DIRECT (through aligned bounce buffers when the destination, offset or
+     * length is not aligned), skipping the page cache; filesystems that refuse O_DIRECT
+     * fall back to buffered pread. POSIX only; on Windows every read goes through fstream.
+     */
+    struct FileReadOptions {
+        size_t parallel_threshold = size_t{ 16 } << 20;
+        size_t chunk_size = size_t{ 8 } << 20;
+        bool direct = false;
+        bool sequential_hint = true;     // posix_fadvise(SEQUENTIAL) on the read descriptor
+    };
+
     /**
      * @brief File-based stream implementation.
      *
      * Wraps std::fstream for file I/O. Implements all Stream virtual methods
      * for reading and writing to files. Can be used anywhere a Stream& is required.
+     * Large reads take the parallel pread path described in FileReadOptions.
      *
      * Usage:
      *   mz::FileStream fs("data.bin");
@@ -185,14 +292,113 @@ namespace mz {
     class FileStream final : public Stream {
         std::fstream file_handle_;
         std::string file_name_;
+        FileReadOptions read_options_;
+
+#if !defined(_WIN32)
+        static constexpr size_t direct_alignment = 4096;
+        int read_fd_ = -1;
+        int direct_fd_ = -1;
+        bool direct_tried_ = false;
+
+        void close_read_fds() noexcept {
+            if (read_fd_ >= 0) ::close(read_fd_);
+            if (direct_fd_ >= 0) ::close(direct_fd_);
+            read_fd_ = direct_fd_ = -1;
+            direct_tried_ = false;
+        }
+
+        static bool pread_full(int fd, char* ptr, size_t size, int64_t offset) noexcept {
+            while (size) {
+                ssize_t const n = ::pread(fd, ptr, size, static_cast<off_t>(offset));
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                ptr += n;
+                size -= static_cast<size_t>(n);
+                offset += n;
+            }
+            return true;
+        }
+
+        // O_DIRECT read of [offset, offset + size); false if the device refused or ended early
+        bool direct_read(char* ptr, size_t size, int64_t offset) const noexcept {
+            size_t const head = static_cast<size_t>(offset) & (direct_alignment - 1);
+            size_t const span = (head + size + direct_alignment - 1) & ~(direct_alignment - 1);
+            if (!head && span == size && !(reinterpret_cast<uintptr_t>(ptr) & (direct_alignment - 1))) {
+                return pread_full(direct_fd_, ptr, size, offset);
+            }
+            char* bounce = static_cast<char*>(::operator new(span, std::align_val_t{ direct_alignment }, std::nothrow));
+            if (!bounce) return false;
+            size_t got{ 0 };
+            for (int64_t const first = offset - static_cast<int64_t>(head); got < head + size; ) {
+                ssize_t const n = ::pread(direct_fd_, bounce + got, span - got, static_cast<off_t>(first + static_cast<int64_t>(got)));
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                got += static_cast<size_t>(n); // a short read at end of file leaves got unaligned; the loop then stops
+                if (got & (direct_alignment - 1)) break;
+            }
+            bool const complete = got >= head + size;
+            if (complete) memcpy(ptr, bounce + head, size);
+            ::operator delete(bounce, std::align_val_t{ direct_alignment });
+            return complete;
+        }
+
+        /**
+         * @brief Reads size bytes at the get position with parallel pread; false if unavailable.
+         */
+        bool parallel_read(char* ptr, size_t size) noexcept {
+            if (file_name_.empty()) return false;
+            file_handle_.flush(); // pending writes must reach the file before pread sees it
+            int64_t const start = static_cast<int64_t>(file_handle_.tellg());
+            if (start < 0) return false;
+            if (read_fd_ < 0) {
+                read_fd_ = ::open(file_name_.c_str(), O_RDONLY | O_CLOEXEC);
+                if (read_fd_ < 0) return false;
+#if defined(__linux__)
+                if (read_options_.sequential_hint) ::posix_fadvise(read_fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+            }
+#if defined(__linux__)
+            if (read_options_.direct && !direct_tried_) {
+                direct_tried_ = true;
+                direct_fd_ = ::open(file_name_.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+            }
+#endif
+            bool const direct = read_options_.direct && direct_fd_ >= 0;
+            size_t chunk = std::max(read_options_.chunk_size, direct_alignment);
+            chunk = (chunk + direct_alignment - 1) & ~(direct_alignment - 1);
+            std::atomic<bool> complete{ true };
+            parallel_for((size + chunk - 1) / chunk, [&](size_t i) {
+                size_t const offset = i * chunk;
+                size_t const n = std::min(chunk, size - offset);
+                int64_t const at = start + static_cast<int64_t>(offset);
+                bool done = direct && direct_read(ptr + offset, n, at);
+                if (!done) done = pread_full(read_fd_, ptr + offset, n, at);
+                if (!done) complete.store(false);
+            });
+            file_handle_.seekg(start + static_cast<int64_t>(size));
+            if (!complete.load()) file_handle_.setstate(std::ios::eofbit | std::ios::failbit);
+            return true;
+        }
+#endif
 
-        void read_bytes(char* ptr, arg_type size) noexcept override final { file_handle_.read(ptr, size); }
+        void read_bytes(char* ptr, arg_type size) noexcept override final {
+#if !defined(_WIN32)
+            if (static_cast<size_t>(size) >= read_options_.parallel_threshold && parallel_read(ptr, static_cast<size_t>(size))) return;
+#endif
+            file_handle_.read(ptr, size);
+        }
         void write_bytes(const char* ptr, arg_type size) noexcept override final { file_handle_.write(ptr, size); }
 
     public:
         void flush() noexcept override final { file_handle_.flush(); }
         void end() override final { file_handle_.seekg(0, file_handle_.end); }
-        void close() override final { file_handle_.close(); file_name_.clear(); }
+        void close() override final {
+#if !defined(_WIN32)
+            close_read_fds();
+#endif
+            file_handle_.close();
+            file_name_.clear();
+        }
         void begin() override final { file_handle_.seekg(std::ios_base::beg); }
         bool is_file() const noexcept override final { return true; }
         bool is_open() const noexcept override final { return file_handle_.is_open(); }
@@ -200,6 +406,9 @@ namespace mz {
             return !file_handle_.is_open() || file_handle_.peek() == std::ifstream::traits_type::eof();
         }
         FileStream& clear() noexcept override final {
+#if !defined(_WIN32)
+            close_read_fds();
+#endif
             file_handle_.close();
             file_handle_.open(file_name_, std::ios::in | std::ios::out | std::ios::binary);
             return *this;
@@ -207,6 +416,20 @@ namespace mz {
         FileStream& operator=(const Stream& rhs) noexcept override final { return clear() << rhs; }
         FileStream& operator<<(const Stream& rhs) noexcept override final { file_handle_ << rhs.rdbuf(); return *this; }
         std::streambuf* rdbuf() const noexcept override final { return file_handle_.rdbuf(); }
+        int64_t tell() noexcept override final { return static_cast<int64_t>(file_handle_.tellg()); }
+        int64_t write_position() noexcept override final { return static_cast<int64_t>(file_handle_.tellp()); }
+        bool overwrite(int64_t offset, const char* ptr, arg_type size) noexcept override final {
+            auto const here = file_handle_.tellp();
+            if (here < 0 || offset < 0 || offset + size > here) return false;
+            file_handle_.seekp(offset);
+            file_handle_.write(ptr, size);
+            return static_cast<bool>(file_handle_.seekp(here));
+        }
+        bool failed() const noexcept override final { return file_handle_.fail(); }
+        bool seek(int64_t offset) noexcept override final {
+            file_handle_.clear();
+            return static_cast<bool>(file_handle_.seekg(offset));
+        }
 
         FileStream() = default;
         FileStream(std::string name) {
@@ -231,7 +454,26 @@ namespace mz {
             file_name_ = std::move(name);
         }
 
-        ~FileStream() { file_handle_.close(); }
+        /**
+         * @brief Sets the large-read policy (see FileReadOptions).
+         *
+         * Usage:
+         *   fs.set_read_options({ .direct = true });
+         */
+        void set_read_options(const FileReadOptions& options) noexcept {
+            read_options_ = options;
+#if !defined(_WIN32)
+            close_read_fds();
+#endif
+        }
+        const FileReadOptions& read_options() const noexcept { return read_options_; }
+
+        ~FileStream() {
+#if !defined(_WIN32)
+            close_read_fds();
+#endif
+            file_handle_.close();
+        }
         void load(const char* /*name*/) override final {}
         void save(const char* /*name*/) override final {}
         FileStream& operator=(const FileStream& rhs) noexcept {
@@ -271,6 +513,20 @@ namespace mz {
         StringStream& operator=(const Stream& rhs) noexcept override final { return clear() << rhs; }
         StringStream& operator<<(const Stream& rhs) noexcept override final { string_handle_ << rhs.rdbuf(); return *this; }
         std::streambuf* rdbuf() const noexcept override final { return string_handle_.rdbuf(); }
+        int64_t tell() noexcept override final { return static_cast<int64_t>(string_handle_.tellg()); }
+        int64_t write_position() noexcept override final { return static_cast<int64_t>(string_handle_.tellp()); }
+        bool overwrite(int64_t offset, const char* ptr, arg_type size) noexcept override final {
+            auto const here = string_handle_.tellp();
+            if (here < 0 || offset < 0 || offset + size > here) return false;
+            string_handle_.seekp(offset);
+            string_handle_.write(ptr, size);
+            return static_cast<bool>(string_handle_.seekp(here));
+        }
+        bool failed() const noexcept override final { return string_handle_.fail(); }
+        bool seek(int64_t offset) noexcept override final {
+            string_handle_.clear();
+            return static_cast<bool>(string_handle_.seekg(offset));
+        }
         StringStream() = default;
 
         /**
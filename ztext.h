@@ -0,0 +1,231 @@
+/*
+ * MIT License
+ * Copyright (c) 2022-2025 Meysam Zare
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MZ_TEXT_HEADER_FILE
+#define MZ_TEXT_HEADER_FILE
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "globals.h"
+#include "zmmap.h"
+#include "thread_utils.h"
+#include "Vector.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MZ_TEXT_SSE2 1
+#endif
+
+/**
+ * @file ztext.h
+ * @brief Fast parsing of delimited numeric text into Vectors.
+ *
+ * This header defines:
+ *   - mz::TextReadOptions: delimiter and parallel chunking parameters.
+ *   - mz::TextReport: value count, and the line, column and byte offset of the first error.
+ *   - mz::parse_text: fills a Vector<int/long long/double/...> from text in memory.
+ *   - mz::read_text_file: the same for a file, parsed straight from a read-only mapping.
+ *
+ * Values are separated by the delimiter, spaces, tabs or line breaks (so both CSV rows
+ * and whitespace-separated columns work); empty fields are skipped. Token ends are found
+ * 16 bytes at a time with SSE2 and each token is converted with std::from_chars, so there
+ * is no locale, no stream state and no allocation per value. Input larger than
+ * parallel_threshold is cut into chunks at separators and parsed on the thread pool.
+ *
+ * Usage example:
+ *   mz::Vector<double> values;
+ *   auto report = mz::read_text_file("samples.csv", values);
+ *   if (!report.ok) mz::print("{} at line {}, column {}\n", report.error, report.error_line, report.error_column);
+ */
+
+namespace mz {
+
+    struct TextReadOptions {
+        char delimiter = ',';
+        size_t parallel_threshold = size_t{ 4 } << 20;   // smaller inputs are parsed on the caller
+        size_t chunk_bytes = size_t{ 1 } << 20;
+        ThreadPool* pool = nullptr;                      // nullptr: ThreadPool::shared()
+    };
+
+    /**
+     * @brief Result of parse_text / read_text_file.
+     */
+    struct TextReport {
+        bool ok = false;
+        size_t values = 0;
+        int64_t error_offset = -1;               // byte offset of the first bad token, -1 if none
+        size_t error_line = 0;                   // 1-based
+        size_t error_column = 0;                 // 1-based, in bytes
+        std::string error;
+    };
+
+    template <typename T>
+    concept TextNumber = (std::integral<T> || std::floating_point<T>) && !std::same_as<T, bool> && !std::same_as<T, char>;
+
+    namespace text_detail {
+
+        inline bool is_separator(char c, char delimiter) noexcept {
+            return c == delimiter || c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+        // First separator in [p, end), or end
+        inline const char* find_separator(const char* p, const char* end, char delimiter) noexcept {
+#if defined(MZ_TEXT_SSE2)
+            __m128i const d = _mm_set1_epi8(delimiter);
+            __m128i const space = _mm_set1_epi8(' ');
+            __m128i const tab = _mm_set1_epi8('\t');
+            __m128i const cr = _mm_set1_epi8('\r');
+            __m128i const lf = _mm_set1_epi8('\n');
+            for (; end - p >= 16; p += 16) {
+                __m128i const v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i const hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, d), _mm_cmpeq_epi8(v, space)),
+                    _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, cr)), _mm_cmpeq_epi8(v, lf)));
+                if (int const mask = _mm_movemask_epi8(hit)) return p + std::countr_zero(static_cast<unsigned>(mask));
+            }
+#endif
+            for (; p < end && !is_separator(*p, delimiter); ++p) {}
+            return p;
+        }
+
+        // Parses [begin, end) into out; returns the offset of the first bad token or -1
+        template <TextNumber T>
+        int64_t parse_range(const char* begin, const char* end, char delimiter, Vector<T>& out) noexcept {
+            out.reserve(static_cast<size_type>((end - begin) / 2 + 1), false);
+            out.clear();
+            T* values = out.data();
+            size_type n = 0;
+            for (const char* p = begin; p < end; ) {
+                if (is_separator(*p, delimiter)) { ++p; continue; }
+                const char* const token_end = find_separator(p, end, delimiter);
+                const char* first = p;
+                if (*first == '+' && token_end - first > 1) ++first;
+                auto const [ptr, ec] = std::from_chars(first, token_end, values[n]);
+                if (ec != std::errc() || ptr != token_end) {
+                    out.resize(n, true);
+                    return p - begin;
+                }
+                ++n;
+                p = token_end;
+            }
+            out.resize(n, true);
+            return -1;
+        }
+
+        inline void describe(std::string_view text, size_t offset, char delimiter, TextReport& report) {
+            size_t const line_start = text.rfind('\n', offset == 0 ? std::string_view::npos : offset - 1);
+            size_t const first = line_start == std::string_view::npos ? 0 : line_start + 1;
+            report.error_offset = static_cast<int64_t>(offset);
+            report.error_line = static_cast<size_t>(std::count(text.begin(), text.begin() + first, '\n')) + 1;
+            report.error_column = offset - first + 1;
+            const char* token_end = find_separator(text.data() + offset, text.data() + text.size(), delimiter);
+            std::string_view token(text.data() + offset, std::min<size_t>(token_end - (text.data() + offset), 32));
+            report.error = std::string("invalid number '").append(token).append("'");
+        }
+
+    } // namespace text_detail
+
+    /**
+     * @brief Parses delimited numbers from text into out.
+     *
+     * On error out holds the values before the bad token and report.ok is false.
+     */
+    template <TextNumber T>
+    TextReport parse_text(std::string_view text, Vector<T>& out, const TextReadOptions& options = {}) {
+        using namespace text_detail;
+        TextReport report;
+        const char* const begin = text.data();
+        const char* const end = begin + text.size();
+        size_t const chunk = std::max<size_t>(options.chunk_bytes, 4096);
+
+        // Chunk boundaries sit on separators, so no token is split
+        std::vector<const char*> cuts{ begin };
+        if (text.size() >= options.parallel_threshold) {
+            for (const char* p = begin + chunk; p < end; p += chunk) {
+                p = find_separator(std::max(p, cuts.back()), end, options.delimiter);
+                if (p < end) cuts.push_back(p);
+            }
+        }
+        cuts.push_back(end);
+        size_t const chunks = cuts.size() - 1;
+
+        out.clear();
+        if (chunks == 1) {
+            int64_t const bad = parse_range(begin, end, options.delimiter, out);
+            report.values = static_cast<size_t>(out.size());
+            if (bad >= 0) describe(text, static_cast<size_t>(bad), options.delimiter, report);
+            report.ok = bad < 0;
+            return report;
+        }
+
+        ThreadPool& pool = options.pool ? *options.pool : ThreadPool::shared();
+        size_t const batch = std::max<size_t>(2 * pool.size(), 1);
+        std::vector<Vector<T>> parsed(std::min(batch, chunks));
+        std::vector<int64_t> bad(parsed.size());
+        for (size_t first = 0; first < chunks; first += batch) {
+            size_t const count = std::min(batch, chunks - first);
+            pool.parallel_for(count, [&](size_t i) {
+                bad[i] = parse_range(cuts[first + i], cuts[first + i + 1], options.delimiter, parsed[i]);
+            });
+            for (size_t i = 0; i < count; i++) {
+                long long const needed = static_cast<long long>(out.size()) + parsed[i].size();
+                if (needed > INT_MAX) {
+                    report.values = static_cast<size_t>(out.size());
+                    report.error_offset = cuts[first + i] - begin;
+                    report.error = "too many values for one Vector";
+                    return report;
+                }
+                if (needed > out.capacity()) out.reserve(static_cast<size_type>(std::min<long long>(std::max(needed, 2ll * out.capacity()), INT_MAX)), true);
+                memcpy(out.data() + out.size(), parsed[i].data(), sizeof(T) * static_cast<size_t>(parsed[i].size()));
+                out.resize(static_cast<size_type>(needed), true);
+                if (bad[i] >= 0) {
+                    report.values = static_cast<size_t>(out.size());
+                    describe(text, static_cast<size_t>(cuts[first + i] - begin + bad[i]), options.delimiter, report);
+                    return report;
+                }
+            }
+        }
+        report.values = static_cast<size_t>(out.size());
+        report.ok = true;
+        return report;
+    }
+
+    /**
+     * @brief Parses a text file through a read-only mapping.
+     * @throws std::domain_error if the file cannot be opened or mapped.
+     */
+    template <TextNumber T>
+    TextReport read_text_file(const std::string& path, Vector<T>& out, const TextReadOptions& options = {}) {
+        MmapStream file(path);
+        file.advise(MmapAdvice::sequential);
+        return parse_text(std::string_view(file.bytes().data(), file.size()), out, options);
+    }
+
+} // namespace mz
+
+#endif // MZ_TEXT_HEADER_FILE